@@ -0,0 +1,83 @@
+/************ ASLBENCH.C ************/
+/*
+ * Host side microbenchmark for the Active Semaphore List.
+ *
+ * The same program is linked once against phase3/asl.c (hash table) and
+ * once against aslList.c (the old sorted list, which cannot grow past
+ * MAXPROC descriptors). It keeps "active" semaphores blocked at once,
+ * spread over a device-like semaphore array, and times a P/V style
+ * insertBlocked/removeBlocked pair and a headBlocked lookup on each of
+ * them in turn.
+ *
+ *   usage: aslBench [active] [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/pcb.h"
+#include "../h/asl.h"
+#include "../h/frame.h"
+
+#define ACTIVEMAX	1024
+#define SEMCOUNT	(2 * ACTIVEMAX)
+
+HIDDEN int sems[SEMCOUNT];
+HIDDEN pcb_PTR procs[ACTIVEMAX];
+
+HIDDEN double nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    int active = (argc > 1) ? atoi(argv[1]) : MAXPROC;
+    long rounds = (argc > 2) ? atol(argv[2]) : 1000000;
+    int stride, i;
+    long r;
+    double start, opNs, headNs;
+    volatile pcb_PTR sink;
+
+    if (active < 1 || active > ACTIVEMAX) {
+        fprintf(stderr, "active must be between 1 and %d\n", ACTIVEMAX);
+        return 1;
+    }
+
+    initFrames();
+    initPcbs();
+    initASL();
+
+    /* Spread the active semaphores over the whole array, like a mix of
+     * device, swap pool and user semaphores. */
+    stride = SEMCOUNT / active;
+    for (i = 0; i < active; i++) {
+        procs[i] = allocPcb();
+        if (procs[i] == NULL || insertBlocked(&sems[i * stride], procs[i])) {
+            fprintf(stderr, "%s ran out of pcbs or descriptors at %d\n", ASLIMPL, i);
+            return 1;
+        }
+    }
+
+    start = nowNs();
+    for (r = 0; r < rounds; r++) {
+        i = r % active;
+        sink = removeBlocked(&sems[i * stride]);
+        insertBlocked(&sems[i * stride], sink);
+    }
+    opNs = (nowNs() - start) / rounds;
+
+    start = nowNs();
+    for (r = 0; r < rounds; r++) {
+        sink = headBlocked(&sems[(r % active) * stride]);
+    }
+    headNs = (nowNs() - start) / rounds;
+
+    printf("%s active=%d rounds=%ld remove+insert=%.1fns headBlocked=%.1fns\n",
+           ASLIMPL, active, rounds, opNs, headNs);
+    return 0;
+}
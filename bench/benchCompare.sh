@@ -0,0 +1,48 @@
+#!/bin/sh
+# Compare the BENCH lines (testers/bench*.c) of several runs.
+#
+# Each argument is a run: a terminal log file, or a directory whose
+# term*.umps files are its terminal logs. For every benchmark it prints
+# the us per operation (per byte for terminal and printer) of each run,
+# and how much each run differs from the first one.
+#
+#   usage: benchCompare.sh baseRun otherRun...
+
+if [ $# -lt 1 ]; then
+	echo "usage: benchCompare.sh baseRun otherRun..." >&2
+	exit 1
+fi
+
+for run in "$@"; do
+	if [ -d "$run" ]; then
+		files="$run/term*.umps"
+	else
+		files="$run"
+	fi
+	# shellcheck disable=SC2086
+	cat $files 2>/dev/null | tr -d '\r' | grep '^BENCH ' | sed "s|^|$run |"
+done | awk '
+{
+	run = $1; name = $3; n = $4; us = $5
+	if (!(run in seenRun)) { seenRun[run] = 1; runs[++nruns] = run }
+	if (!(name in seenName)) { seenName[name] = 1; names[++nnames] = name }
+	if (n > 0) per[run, name] = us / n
+}
+END {
+	printf "%-12s", "benchmark"
+	for (r = 1; r <= nruns; r++) printf " %22s", runs[r]
+	printf "\n"
+	for (b = 1; b <= nnames; b++) {
+		name = names[b]
+		printf "%-12s", name
+		for (r = 1; r <= nruns; r++) {
+			if (!((runs[r], name) in per)) { printf " %22s", "-"; continue }
+			v = per[runs[r], name]
+			if (r == 1 || !((runs[1], name) in per) || per[runs[1], name] == 0)
+				printf " %13.2f us/op   ", v
+			else
+				printf " %13.2f us/op %+5.0f%%", v, 100 * (v - per[runs[1], name]) / per[runs[1], name]
+		}
+		printf "\n"
+	}
+}'
@@ -0,0 +1,19 @@
+#ifndef HOSTCONST
+#define HOSTCONST
+
+/************************** HOSTCONST.H ******************************
+*
+*  Forced into every host build with -include. It pulls in the real
+*    const.h, whose include guard keeps later includes from running
+*    again, and then gives NULL the value the host C library expects
+*    instead of the uMPS3 0xFFFFFFFF.
+*/
+
+#include "../h/const.h"
+
+#undef NULL
+#define NULL ((void *) 0)
+
+/***************************************************************/
+
+#endif
@@ -0,0 +1,29 @@
+/************ HOSTFRAMES.C ************/
+/*
+ * Host stand-in for phase3/frame.c. The pools grow out of a static arena
+ * instead of the RAM the uMPS3 bus registers describe. Build with
+ * -DHOSTFRAMES=n to change how many frames the arena holds.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/frame.h"
+
+#ifndef HOSTFRAMES
+#define HOSTFRAMES	64
+#endif
+
+HIDDEN char arena[HOSTFRAMES * PAGESIZE] __attribute__ ((aligned (PAGESIZE)));
+HIDDEN int framesUsed;
+
+void initFrames()
+{
+    framesUsed = 0;
+}
+
+memaddr allocFrame()
+{
+    if (framesUsed == HOSTFRAMES)
+        return (memaddr) NULL;
+    return (memaddr) &arena[PAGESIZE * framesUsed++];
+}
@@ -0,0 +1,53 @@
+/************ HOSTUMPS.C ************/
+/*
+ * Host stand-in for the parts of libumps the phase 1 test uses, so
+ * p1test.c can run as an ordinary program. PANIC() and HALT() exit, and
+ * the progress messages p1test collects in okbuf are printed at exit in
+ * place of terminal 0.
+ *
+ * p1test still pokes terminal 0's device registers directly. The page
+ * they live in is mapped to plain zeroed memory before main() runs, so
+ * the terminal always reads as not ready and nothing is written.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include "../h/const.h"
+
+#define DEVREGPAGE	0x10000000	/* page holding the uMPS3 device registers */
+#define HOSTPAGESIZE	4096
+
+extern char okbuf[], errbuf[];
+
+HIDDEN int panicked = FALSE;
+
+void PANIC()
+{
+    panicked = TRUE;
+    exit(1);
+}
+
+void HALT()
+{
+    exit(0);
+}
+
+HIDDEN void printOk()
+{
+    printf("%s", okbuf);
+    if (panicked)
+        printf("PANIC: %s\n", errbuf);
+}
+
+__attribute__ ((constructor)) HIDDEN void mapDevRegs()
+{
+    void *page = mmap((void *) DEVREGPAGE, HOSTPAGESIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (page == MAP_FAILED) {
+        perror("hostUmps: mapping the device register page");
+        exit(2);
+    }
+    atexit(printOk);
+}
@@ -0,0 +1,99 @@
+/************ QUEUEBENCH.C ************/
+/*
+ * Host side cycle count benchmark for process queue operations.
+ *
+ * Lays n pcbs out in shuffled order in an arena, once packed at the size
+ * of the hot pcb_t record and once spread at the size pcb_t would have
+ * with the 140 byte state_t and the pcbacct_t inside it, then times the
+ * same work on both: rotating the queue with removeProcQ/insertProcQ, and
+ * walking it reading the ready level and blocking fields the way the
+ * scheduler and the ASL do.
+ *
+ *   usage: queueBench [n] [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/pcb.h"
+
+/* what sizeof(pcb_t) would be with the cold slots inline instead of behind p_s and p_acct */
+#define FATPCBSIZE	(sizeof(pcb_t) - sizeof(state_PTR) - sizeof(pcbacct_t *) + sizeof(state_t) + sizeof(pcbacct_t))
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES()	__rdtsc()
+#define UNIT		"cycles"
+#else
+#define CYCLES()	nowNs()
+#define UNIT		"ns"
+
+HIDDEN unsigned long long nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+#endif
+
+HIDDEN void run(char *layout, size_t stride, int n, long rounds)
+{
+    char *arena = malloc(stride * n);
+    int *order = malloc(sizeof(int) * n);
+    pcb_PTR queue = mkEmptyProcQ();
+    unsigned long long start, rotate = 0, walk = 0;
+    long r, sum = 0;
+    int i;
+
+    /* Shuffle the insertion order so the walk cannot lean on prefetch. */
+    for (i = 0; i < n; i++) order[i] = i;
+    for (i = n - 1; i > 0; i--) {
+        int j = rand() % (i + 1), t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+    for (i = 0; i < n; i++) {
+        pcb_PTR p = (pcb_PTR) (arena + (stride * order[i]));
+        p->p_level = i;
+        p->p_semAdd = NULL;
+        p->p_queue = NULL;
+        insertProcQ(&queue, p);
+    }
+
+    for (r = 0; r < rounds; r++) {
+        pcb_PTR p;
+
+        start = CYCLES();
+        for (i = 0; i < n; i++) {
+            insertProcQ(&queue, removeProcQ(&queue));
+        }
+        rotate += CYCLES() - start;
+
+        start = CYCLES();
+        p = queue;
+        do {
+            sum += p->p_level + (p->p_semAdd != NULL);
+            p = p->p_next;
+        } while (p != queue);
+        walk += CYCLES() - start;
+    }
+
+    printf("queueBench %s pcb=%zuB n=%d rotate=%.1f %s/op walk=%.1f %s/pcb (%ld)\n",
+           layout, stride, n, (double) rotate / ((double) rounds * n), UNIT,
+           (double) walk / ((double) rounds * n), UNIT, sum & 1);
+    free(arena);
+    free(order);
+}
+
+int main(int argc, char *argv[])
+{
+    int n = (argc > 1) ? atoi(argv[1]) : 4096;
+    long rounds = (argc > 2) ? atol(argv[2]) : 1000;
+
+    srand(320);
+    run("fat", FATPCBSIZE, n, rounds);
+    run("hot", sizeof(pcb_t), n, rounds);
+    return 0;
+}
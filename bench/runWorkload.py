@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+"""Boot the nucleus on a workload of tester images and report how it went.
+
+Generates a uMPS3 machine configuration in a scratch directory, attaches
+the chosen testers/*.umps images as flash devices (the first one becomes
+the U-proc with ASID 1, and so on), runs the simulator without anyone at
+the controls and collects the terminal and printer output files. The run
+ends when terminal 0 says the machine halted or panicked, when no output
+file has changed for --quiet seconds, or after --timeout seconds.
+
+The report is JSON with sorted keys so two of them diff cleanly: how the
+run ended, every "BENCH name n us" line (testers/print.c), every other
+output line carrying a time in us, and the raw device output.
+
+  usage: runWorkload.py [options] tester...
+  e.g.   runWorkload.py --cpus 2 -o rr.json fibEleven fibEleven benchSyscall
+
+uMPS3 has no batch mode of its own, so --sim names the command that runs
+it with a configuration file; the default uses xvfb-run to give the GUI a
+display to open on. It must power the machine on by itself.
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+REPO = os.path.dirname(HERE)
+
+MAXFLASH = 8  # USERPROCMAX in h/const.h
+HALTED = re.compile(r"SYSTEM HALTED", re.I)
+PANICKED = re.compile(r"KERNEL PANIC", re.I)
+BENCH = re.compile(r"^BENCH (\S+) (\d+) (\d+)$")
+TIMING = re.compile(r"(\d+) us\b")
+
+
+def umpsShare():
+    for prefix in ("/usr", "/usr/local"):
+        share = os.path.join(prefix, "share", "umps3")
+        if os.path.isdir(share):
+            return share
+    return "/usr/share/umps3"
+
+
+def machineConfig(args, flashes):
+    """The uMPS3 JSON machine configuration for this run."""
+    share = umpsShare()
+    devices = {}
+    for i in range(MAXFLASH):
+        devices["terminal%d" % i] = {"enabled": True, "file": "term%d.umps" % i}
+        devices["printer%d" % i] = {"enabled": True, "file": "printer%d.umps" % i}
+    for i, name in enumerate(flashes):
+        devices["flash%d" % i] = {"enabled": True, "file": name}
+    return {
+        "num-processors": args.cpus,
+        "clock-rate": args.clock,
+        "tlb-size": 16,
+        "tlb-floor-address": "0x80000000",
+        "ram-size": args.ram,
+        "bootstrap-rom": os.path.join(share, "coreboot.rom.umps"),
+        "execution-rom": os.path.join(share, "exec.rom.umps"),
+        "boot": {"load-core-file": True, "core-file": "kernel.core.umps"},
+        "symbol-table": {"asid": 64, "file": "kernel.stab.umps"},
+        "devices": devices,
+    }
+
+
+def outputFiles(run):
+    return sorted(f for f in os.listdir(run)
+                  if f.startswith("term") or f.startswith("printer"))
+
+
+def readOutput(run, name):
+    with open(os.path.join(run, name), "rb") as f:
+        return f.read().decode("ascii", "replace").replace("\r", "")
+
+
+def runSimulator(args, run):
+    """Run the simulator in run until it halts, goes quiet or times out."""
+    config = os.path.join(run, "config.json")
+    command = shlex.split(args.sim) + [config]
+    start = time.time()
+    last = start
+    seen = {}
+    proc = subprocess.Popen(command, cwd=run, stdout=subprocess.DEVNULL,
+                            stderr=subprocess.DEVNULL)
+    ended = "timeout"
+    try:
+        while time.time() - start < args.timeout:
+            time.sleep(0.5)
+            if proc.poll() is not None:
+                ended = "exited"
+                break
+            for name in outputFiles(run):
+                size = os.path.getsize(os.path.join(run, name))
+                if seen.get(name) != size:
+                    seen[name] = size
+                    last = time.time()
+            term0 = readOutput(run, "term0.umps")
+            if PANICKED.search(term0):
+                ended = "panic"
+                break
+            if HALTED.search(term0):
+                ended = "halted"
+                break
+            if time.time() - last > args.quiet:
+                ended = "quiet"
+                break
+    finally:
+        if proc.poll() is None:
+            proc.terminate()
+            try:
+                proc.wait(5)
+            except subprocess.TimeoutExpired:
+                proc.kill()
+    return ended, time.time() - start
+
+
+def parseOutput(run):
+    """BENCH lines, other lines with a time in us, and the raw output."""
+    benchmarks = {}
+    timings = []
+    raw = {}
+    for name in outputFiles(run):
+        device = name[:-len(".umps")]
+        text = readOutput(run, name)
+        if text:
+            raw[device] = text
+        for line in text.splitlines():
+            bench = BENCH.match(line)
+            if bench:
+                n, us = int(bench.group(2)), int(bench.group(3))
+                benchmarks.setdefault(bench.group(1), []).append({
+                    "device": device, "n": n, "us": us,
+                    "us_per_op": round(us / n, 3) if n else None})
+                continue
+            timing = TIMING.search(line)
+            if timing:
+                timings.append({"device": device, "line": line.strip(),
+                                "us": int(timing.group(1))})
+    return benchmarks, timings, raw
+
+
+def sha1(path):
+    with open(path, "rb") as f:
+        return hashlib.sha1(f.read()).hexdigest()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("testers", nargs="+",
+                        help="tester names or .umps paths, one flash device each")
+    parser.add_argument("-k", "--kernel", default=os.path.join(REPO, "phase3", "kernel"),
+                        help="kernel to boot, without the .core.umps suffix (phase3/kernel)")
+    parser.add_argument("-o", "--output", help="write the JSON report here, not to stdout")
+    parser.add_argument("--cpus", type=int, default=1)
+    parser.add_argument("--ram", type=int, default=64, help="RAM in frames")
+    parser.add_argument("--clock", type=int, default=1, help="TOD clock rate in MHz")
+    parser.add_argument("--timeout", type=float, default=300, help="longest run in s")
+    parser.add_argument("--quiet", type=float, default=30,
+                        help="end the run after this many s without output")
+    parser.add_argument("--sim", default=os.environ.get("UMPS3", "xvfb-run -a umps3"),
+                        help="command that runs uMPS3 on a configuration file ($UMPS3)")
+    parser.add_argument("--keep", help="run in this directory and keep it")
+    args = parser.parse_args()
+
+    if len(args.testers) > MAXFLASH:
+        parser.error("at most %d testers, one per flash device" % MAXFLASH)
+    core = args.kernel + ".core.umps"
+    if not os.path.isfile(core):
+        parser.error("%s not found, build it first" % core)
+
+    run = args.keep or tempfile.mkdtemp(prefix="pandos-run-")
+    os.makedirs(run, exist_ok=True)
+    shutil.copy(core, os.path.join(run, "kernel.core.umps"))
+    if os.path.isfile(args.kernel + ".stab.umps"):
+        shutil.copy(args.kernel + ".stab.umps", os.path.join(run, "kernel.stab.umps"))
+    flashes = []
+    for i, tester in enumerate(args.testers):
+        path = tester if tester.endswith(".umps") else \
+            os.path.join(REPO, "testers", tester + ".umps")
+        if not os.path.isfile(path):
+            parser.error("%s not found, run make in testers" % path)
+        flashes.append("flash%d.umps" % i)
+        shutil.copy(path, os.path.join(run, flashes[-1]))
+    for i in range(MAXFLASH):
+        for device in ("term%d.umps", "printer%d.umps"):
+            open(os.path.join(run, device % i), "w").close()
+    with open(os.path.join(run, "config.json"), "w") as f:
+        json.dump(machineConfig(args, flashes), f, indent=4)
+
+    ended, seconds = runSimulator(args, run)
+    benchmarks, timings, raw = parseOutput(run)
+    report = {
+        "kernel": os.path.relpath(core, REPO),
+        "kernel_sha1": sha1(core),
+        "cpus": args.cpus,
+        "workload": args.testers,
+        "ended": ended,
+        "wall_seconds": round(seconds, 1),
+        "benchmarks": benchmarks,
+        "timings": timings,
+        "output": raw,
+    }
+    text = json.dumps(report, indent=2, sort_keys=True) + "\n"
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    if not args.keep:
+        shutil.rmtree(run)
+    return 0 if ended in ("halted", "quiet") else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
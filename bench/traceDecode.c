@@ -0,0 +1,169 @@
+/************ TRACEDECODE.C ************/
+/*
+ * Host side decoder for the nucleus event trace (phase3/trace.c).
+ *
+ * Reads either a raw dump of uMPS3 RAM from RAMSTART on, in which it looks
+ * for traceBuf by its t_magic word and follows t_ring to each ring, or the printer 0 log of a nucleus built with
+ * TRACE=TRUE, which starts with the "T" line dumpTrace() writes. The
+ * events of every processor are merged by TOD and printed as a timeline,
+ * one event per line, in us since the first one.
+ *
+ *   usage: traceDecode file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../h/trace.h"
+
+typedef struct event_t {
+    unsigned int cpu;
+    traceevent_t e;
+} event_t;
+
+HIDDEN event_t events[MAXCPUS * TRACESIZE];
+HIDDEN int nevents;
+HIDDEN unsigned int timescale = 1;
+
+HIDDEN void addEvent(unsigned int cpu, traceevent_t *e)
+{
+    if (nevents < MAXCPUS * TRACESIZE && e->e_type > 0 && e->e_type < TRTYPES) {
+        events[nevents].cpu = cpu;
+        events[nevents].e = *e;
+        nevents++;
+    }
+}
+
+/* A printer log: "T scale size ncpus" then "E cpu tod type a b", in hex. */
+HIDDEN int readLog(FILE *f)
+{
+    char line[128];
+    unsigned int size, ncpus, cpu;
+    traceevent_t e;
+
+    if (fgets(line, sizeof(line), f) == NULL
+        || sscanf(line, "T %x %x %x", &timescale, &size, &ncpus) != 3) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (sscanf(line, "E %x %x %x %x %x", &cpu, &e.e_tod, &e.e_type, &e.e_a, &e.e_b) == 5) {
+            addEvent(cpu, &e);
+        }
+    }
+    return 1;
+}
+
+/* A RAM dump: find a word aligned tracebuf_t that looks sane, then copy
+ * out what each ring still holds, from the frame t_ring says it is in. */
+HIDDEN int readDump(FILE *f)
+{
+    long length;
+    char *image;
+    tracebuf_t *t = NULL;
+    unsigned int cpu, i, first;
+    long off, ring;
+
+    fseek(f, 0, SEEK_END);
+    length = ftell(f);
+    rewind(f);
+    image = malloc(length);
+    if (image == NULL || fread(image, 1, length, f) != (size_t) length) {
+        return 0;
+    }
+    for (off = 0; off + (long) sizeof(tracebuf_t) <= length; off += sizeof(unsigned int)) {
+        tracebuf_t *c = (tracebuf_t *) (image + off);
+        if (c->t_magic == TRACEMAGIC && c->t_size == TRACESIZE
+            && c->t_ncpus > 0 && c->t_ncpus <= MAXCPUS) {
+            t = c;
+            break;
+        }
+    }
+    if (t == NULL) {
+        free(image);
+        return 0;
+    }
+    timescale = t->t_timescale;
+    for (cpu = 0; cpu < t->t_ncpus; cpu++) {
+        ring = (long) t->t_ring[cpu] - RAMSTART;
+        if (ring < 0 || ring + (long) (TRACESIZE * sizeof(traceevent_t)) > length) {
+            continue; /* the dump stops short of this ring */
+        }
+        first = (t->t_next[cpu] > TRACESIZE) ? t->t_next[cpu] - TRACESIZE : 0;
+        for (i = first; i < t->t_next[cpu]; i++) {
+            addEvent(cpu, &((traceevent_t *) (image + ring))[i & (TRACESIZE - 1)]);
+        }
+    }
+    free(image);
+    return 1;
+}
+
+HIDDEN int byTod(const void *a, const void *b)
+{
+    unsigned int x = ((const event_t *) a)->e.e_tod;
+    unsigned int y = ((const event_t *) b)->e.e_tod;
+    return (x > y) - (x < y);
+}
+
+HIDDEN void printEvent(event_t *v, unsigned int start)
+{
+    traceevent_t *e = &v->e;
+
+    printf("%10u  cpu%u  ", (e->e_tod - start) / timescale, v->cpu);
+    switch (e->e_type) {
+    case TRDISPATCH:
+        printf("dispatch    pcb %08x for %u us\n", e->e_a, e->e_b);
+        break;
+    case TRBLOCK:
+        printf("block       pcb %08x on sem %08x\n", e->e_b, e->e_a);
+        break;
+    case TRUNBLOCK:
+        printf("unblock     pcb %08x from sem %08x\n", e->e_b, e->e_a);
+        break;
+    case TRINTERRUPT:
+        printf("interrupt   line %u device %u\n", e->e_a, e->e_b);
+        break;
+    case TRSYSENTER:
+        printf("sys enter   SYS%u by pcb %08x\n", e->e_a, e->e_b);
+        break;
+    case TRSYSEXIT:
+        printf("sys exit    SYS%u v0 %d\n", e->e_a, (int) e->e_b);
+        break;
+    case TRPAGEFAULT:
+        printf("page fault  asid %u page %u\n", e->e_a, e->e_b);
+        break;
+    case TREVICT:
+        printf("evict       asid %u page %u\n", e->e_a, e->e_b);
+        break;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *f;
+    char first[2];
+    int ok, i;
+
+    if (argc != 2 || (f = fopen(argv[1], "rb")) == NULL) {
+        fprintf(stderr, "usage: traceDecode ramdump|printerlog\n");
+        return 1;
+    }
+    ok = fread(first, 1, 2, f) == 2 && first[0] == 'T' && first[1] == ' ';
+    rewind(f);
+    ok = ok ? readLog(f) : readDump(f);
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "%s: no trace found\n", argv[1]);
+        return 1;
+    }
+    if (timescale == 0) {
+        timescale = 1;
+    }
+
+    /* the TOD low word wraps after about 71 minutes at 1 tick per us */
+    qsort(events, nevents, sizeof(event_t), byTod);
+    printf("%d events\n", nevents);
+    for (i = 0; i < nevents; i++) {
+        printEvent(&events[i], events[0].e.e_tod);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/************ TREEBENCH.C ************/
+/*
+ * Host side benchmark for the process tree.
+ *
+ * Builds a root with "width" children, growing the PCB pool past MAXPROC
+ * as needed, then times detaching every child with outChild() starting
+ * from the oldest one (the end of the sibling list), and tearing the same
+ * tree down with removeChild() the way terminateProc() does.
+ *
+ *   usage: treeBench [width] [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/pcb.h"
+#include "../h/frame.h"
+
+#define WIDTHMAX	1024
+
+HIDDEN pcb_PTR kids[WIDTHMAX];
+
+HIDDEN double nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    int width = (argc > 1) ? atoi(argv[1]) : 200;
+    long rounds = (argc > 2) ? atol(argv[2]) : 1000000;
+    double start, buildNs = 0, outNs = 0, removeNs = 0;
+    pcb_PTR root;
+    long r;
+    int i;
+
+    if (width < 1 || width > WIDTHMAX) {
+        fprintf(stderr, "width must be between 1 and %d\n", WIDTHMAX);
+        return 1;
+    }
+
+    initFrames();
+    initPcbs();
+    root = allocPcb();
+    for (i = 0; i < width; i++) {
+        kids[i] = allocPcb();
+        if (kids[i] == NULL) {
+            fprintf(stderr, "PCB pool ran out at %d children\n", i);
+            return 1;
+        }
+    }
+
+    for (r = 0; r < rounds; r++) {
+        start = nowNs();
+        for (i = 0; i < width; i++) {
+            insertChild(root, kids[i]);
+        }
+        buildNs += nowNs() - start;
+
+        /* kids[0] went in first, so it sits at the end of the list. */
+        start = nowNs();
+        for (i = 0; i < width; i++) {
+            if (outChild(kids[i]) != kids[i]) {
+                fprintf(stderr, "outChild lost child %d\n", i);
+                return 1;
+            }
+        }
+        outNs += nowNs() - start;
+
+        for (i = 0; i < width; i++) {
+            insertChild(root, kids[i]);
+        }
+        start = nowNs();
+        while (removeChild(root) != NULL);
+        removeNs += nowNs() - start;
+
+        if (!emptyChild(root)) {
+            fprintf(stderr, "removeChild left children behind\n");
+            return 1;
+        }
+    }
+
+    printf("treeBench width=%d rounds=%ld insertChild=%.1fns outChild=%.1fns removeChild=%.1fns\n",
+           width, rounds, buildNs / (rounds * width), outNs / (rounds * width),
+           removeNs / (rounds * width));
+    return 0;
+}
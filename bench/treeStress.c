@@ -0,0 +1,202 @@
+/************ TREESTRESS.C ************/
+/*
+ * Host side stress test for process tree teardown.
+ *
+ * Grows the PCB pool to "size" PCBs, past the MAXPROC it starts with,
+ * as random process trees whose members are spread
+ * over the ready queue and a set of semaphores, then repeatedly kills a
+ * random subtree the way terminateProc() does and regrows the trees.
+ * After every kill it checks that each queue still holds exactly the
+ * live PCBs it should, that outProcQ() refuses a PCB that is on another
+ * queue, and that every PCB is either live or back on the free list.
+ *
+ *   usage: treeStress [rounds] [size] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/pcb.h"
+#include "../h/asl.h"
+#include "../h/frame.h"
+
+#define SEMCOUNT	8
+#define SIZEMAX		1024
+
+HIDDEN pcb_PTR readyQueue;
+HIDDEN int sems[SEMCOUNT];
+HIDDEN pcb_PTR live[SIZEMAX];
+HIDDEN int liveCount, size;
+HIDDEN long failures;
+
+HIDDEN double nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+HIDDEN void check(int cond, char *what)
+{
+    if (!cond) {
+        failures++;
+        fprintf(stderr, "treeStress: %s\n", what);
+    }
+}
+
+HIDDEN void forget(pcb_PTR p)
+{
+    int i;
+    for (i = 0; i < liveCount; i++) {
+        if (live[i] == p) {
+            live[i] = live[--liveCount];
+            return;
+        }
+    }
+    check(FALSE, "killed a PCB that was not live");
+}
+
+/* Same teardown as terminateProc()/reapProc() in phase3/exceptions.c. */
+HIDDEN void reap(pcb_PTR p)
+{
+    if (p->p_queue == &readyQueue) {
+        check(outProcQ(&readyQueue, p) == p, "outProcQ lost a ready PCB");
+    } else if (p->p_semAdd != NULL) {
+        int *semAdd = p->p_semAdd;
+        check(outBlocked(p) == p, "outBlocked lost a blocked PCB");
+        (*semAdd)++;
+    }
+    check(p->p_queue == NULL, "PCB still tagged after removal");
+    freePcb(p);
+    forget(p);
+}
+
+HIDDEN void killTree(pcb_PTR root)
+{
+    pcb_PTR p = root, parent;
+    outChild(root);
+    while (p != NULL) {
+        while (!emptyChild(p)) {
+            p = p->p_child;
+        }
+        parent = p->p_prnt;
+        outChild(p);
+        reap(p);
+        p = parent;
+    }
+}
+
+/* Allocate back up to size PCBs, hanging each new one off a random live
+ * one and parking it on the ready queue or a random semaphore. */
+HIDDEN void grow()
+{
+    pcb_PTR p;
+    while (liveCount < size && (p = allocPcb()) != NULL) {
+        if (liveCount > 0) {
+            insertChild(live[rand() % liveCount], p);
+        }
+        if (rand() % 2) {
+            insertProcQ(&readyQueue, p);
+        } else {
+            int *semAdd = &sems[rand() % SEMCOUNT];
+            (*semAdd)--;
+            insertBlocked(semAdd, p);
+        }
+        live[liveCount++] = p;
+    }
+}
+
+HIDDEN int queueLength(pcb_PTR tp)
+{
+    int n = 0;
+    pcb_PTR p = tp;
+    if (emptyProcQ(tp)) return 0;
+    do {
+        n++;
+        p = p->p_next;
+    } while (p != tp);
+    return n;
+}
+
+HIDDEN void audit()
+{
+    int onReady = 0, blocked = 0, i;
+    for (i = 0; i < liveCount; i++) {
+        if (live[i]->p_queue == &readyQueue) {
+            onReady++;
+            check(outProcQ(&readyQueue, live[i]) == live[i], "ready PCB not found");
+            insertProcQ(&readyQueue, live[i]);
+        } else {
+            blocked++;
+            check(outProcQ(&readyQueue, live[i]) == NULL,
+                  "outProcQ removed a PCB from the wrong queue");
+        }
+    }
+    check(queueLength(readyQueue) == onReady, "ready queue length mismatch");
+    for (i = 0; i < SEMCOUNT; i++) {
+        blocked += sems[i];
+    }
+    check(blocked == 0, "semaphore values disagree with blocked PCBs");
+}
+
+int main(int argc, char *argv[])
+{
+    long rounds = (argc > 1) ? atol(argv[1]) : 100000;
+    unsigned seed = (argc > 3) ? atoi(argv[3]) : 320;
+    long r, kills = 0;
+    double start, elapsed = 0;
+    int i;
+
+    size = (argc > 2) ? atoi(argv[2]) : 4 * MAXPROC;
+    if (size < 1 || size > SIZEMAX) {
+        fprintf(stderr, "size must be between 1 and %d\n", SIZEMAX);
+        return 1;
+    }
+
+    srand(seed);
+    initFrames();
+    initPcbs();
+    initASL();
+    readyQueue = mkEmptyProcQ();
+
+    for (r = 0; r < rounds; r++) {
+        pcb_PTR victim;
+        int before;
+
+        grow();
+        check(liveCount == size, "PCB pool did not refill");
+
+        /* Prefer roots now and then so whole trees die, not just leaves. */
+        victim = live[rand() % liveCount];
+        if (rand() % 4 == 0) {
+            while (victim->p_prnt != NULL) victim = victim->p_prnt;
+        }
+        before = liveCount;
+        start = nowNs();
+        killTree(victim);
+        elapsed += nowNs() - start;
+        kills += before - liveCount;
+
+        audit();
+    }
+
+    /* Tear everything down and make sure the whole pool comes back. */
+    while (liveCount > 0) {
+        pcb_PTR root = live[0];
+        while (root->p_prnt != NULL) root = root->p_prnt;
+        killTree(root);
+    }
+    /* Freed PCBs must all be reusable before the pool carves any more. */
+    for (i = 0; i < size; i++) {
+        live[i] = allocPcb();
+    }
+    for (i = 0; i < size; i++) {
+        check(live[i] != NULL && live[i]->p_queue == NULL, "PCB lost after full teardown");
+    }
+
+    printf("treeStress rounds=%ld size=%d killed=%ld avg=%.1fns/pcb failures=%ld\n",
+           rounds, size, kills, kills ? elapsed / kills : 0.0, failures);
+    return failures != 0;
+}
@@ -0,0 +1,17 @@
+#ifndef ACCOUNT
+#define ACCOUNT
+
+/************************** ACCOUNT.H ******************************
+*
+*  The externals declaration file for the cpu time accounting the
+*    nucleus does on every entry and exit.
+*/
+
+#include "../h/types.h"
+
+extern void chargeCurrent (int bucket);
+extern cpu_t cpuTime (pcb_PTR p, int bucket);
+
+/***************************************************************/
+
+#endif
@@ -82,11 +82,58 @@
 /* Macro to load the Interval Timer */
 #define LDIT(T)	((* ((cpu_t *) INTERVALTMR)) = (T) * (* ((cpu_t *) TIMESCALEADDR)))
 
+/* Macro to push the Interval Timer as far out as it goes, which also
+ * acknowledges its interrupt */
+#define STOPIT()	((* ((cpu_t *) INTERVALTMR)) = TIMEROFF)
+#define TIMEROFF	0xFFFFFFFF
+
 /* Macro to read the TOD clock */
 #define STCK(T) ((T) = ((* ((cpu_t *) TODLOADDR)) / (* ((cpu_t *) TIMESCALEADDR))))
-#define MAXPROC 20
+#define MAXPROC 20 /* pcbs and semds available before their pools have to grow */
+#define PROCSTACKFRAMES 32 /* frames at the top of RAM left to process stacks, never carved into pools */
+#define SEMDHASHSIZE 256 /* buckets in the ASL hash table, must be a power of two */
 #define IOCLOCK 100000 /* aka 100 ms */
-#define QUANTUM 5000
+#define TODBEFORE(a, b) ((int) ((a) - (b)) < 0) /* TRUE if TOD a comes before TOD b, which wraps around */
+#define TIMERTICK 1000 /* us per timer wheel tick, what SLEEP rounds up to */
+#define WHEELLEVELS 2
+#define WHEELSLOTS 64 /* slots per timer wheel level */
+#ifndef TICKLESS
+#define TICKLESS TRUE /* only run the interval timer while someone waits for the pseudo-clock */
+#endif
+#define IDLEPOLLMAX (4 * QUANTUM) /* longest an idle processor waits before looking for work again */
+#define INTLINES 8 /* interrupt lines, 0 to 7 */
+#define IOPASSES 4 /* times IOHandler() reads Cause.IP again before scheduling */
+#ifndef DEFERRED
+#define DEFERRED TRUE /* TRUE: IOHandler() only acknowledges, scheduler() does the wakeups */
+#endif
+#define DEVRING 4 /* completions a device may have queued for the bottom half */
+#define DEVRINGRECV 0x80000000 /* flags a queued terminal status as the receiver's */
+#define QUANTUM 5000 /* time slice a new process gets, SETQUANTUM changes it */
+#define MINQUANTUM 1000
+#define MAXQUANTUM 100000
+
+/* scheduling policies, picked at compile time with -DSCHEDPOLICY (make SCHED=MLFQ) */
+#define SCHEDRR 0 /* round robin on one ready queue, every process gets QUANTUM */
+#define SCHEDMLFQ 1 /* multi-level feedback queue */
+#define SCHEDSTRIDE 2 /* stride scheduling, cpu shares follow the SETWEIGHT weights */
+#ifndef SCHEDPOLICY
+#define SCHEDPOLICY SCHEDRR
+#endif
+#define MLFQLEVELS 3 /* ready levels, level 0 runs first and level n gets QUANTUM << n */
+#define MLFQBOOST 1000000 /* aka 1 s between moving every ready process back to level 0 */
+#define DEFAULTWEIGHT 10 /* weight of a new process */
+#define MAXWEIGHT 100
+#define STRIDE1 (1 << 16) /* pass charged to a weight 1 process per STRIDEUNIT of cpu time */
+#define STRIDEUNIT 100 /* us */
+
+/* real-time class, run earliest deadline first ahead of whichever SCHEDPOLICY */
+#define RTMAXPERIOD 1000000 /* aka 1 s, longest period a real-time process may declare */
+#define RTMAXLOAD 900 /* per mille of the cpu admission control hands out, the rest stays best effort */
+#define RTSTATSELF 0 /* GETRTSTATS a1: deadlines missed by the caller */
+#define RTSTATALL 1 /* GETRTSTATS a1: deadlines missed by every real-time process */
+#ifndef HANDOFF
+#define HANDOFF FALSE /* TRUE: a V gives the rest of the caller's quantum to the process it wakes */
+#endif
 #define INTERVAL
 
 /* syscalls */
@@ -98,11 +145,69 @@
 #define GETCPUTIME 6
 #define WAITCLOCK 7
 #define GETSUPPORTPTR 8
+#define SETWEIGHT 21 /* same number at the support level */
+#define SETREALTIME 22 /* same number at the support level */
+#define GETRTSTATS 23 /* same number at the support level */
+#define GETCPUSTATS 24 /* same number at the support level */
+#define SETQUANTUM 25 /* same number at the support level */
+#define DUMPSYSSTATS 26 /* same number at the support level */
+#define GETINTLATENCY 27 /* same number at the support level */
+#define SLEEP 28 /* a1 us, see timer.c; DELAY (18) at the support level takes seconds */
+#define MAXSYSCALL 32 /* syscall numbers below this are counted by SYSSTATS */
+
+/* syscall counters and latency histograms, see sysStats.c (make SYSSTATS=TRUE) */
+#ifndef SYSSTATS
+#define SYSSTATS FALSE
+#endif
+#define STATBUCKETS 16 /* log2 us latency buckets, the last one takes everything above 32 ms */
+#define STATSTERM 0
+#define STATSPRINTER 1
+#ifndef SYSSTATSOUT
+#define SYSSTATSOUT STATSTERM /* where dumpSysStats() writes */
+#endif
+
+/* event trace ring, see trace.c (make TRACE=TRUE) */
+#ifndef TRACE
+#define TRACE FALSE
+#endif
+#define TRACESIZE 256 /* events kept per processor, a power of 2 whose ring fills one frame */
+#define TRACEMAGIC 0x54524345 /* "TRCE" */
+
+/* cpu time buckets, see account.c, and GETCPUSTATS a1 */
+#define ACCTUSER 0 /* running the process's own code, support level included */
+#define ACCTSYS 1 /* in the nucleus on the process's behalf */
+#define ACCTINT 2 /* handling interrupts that came while it ran */
+#define ACCTALL 3 /* ACCTUSER + ACCTSYS, what GETCPUTIME reports */
+#define ACCTDISPATCHES 4 /* not a time: how many times the process was dispatched */
+
+/* GETINTLATENCY a3: statistic of the us from an interrupt of device a2 on
+ * line a1 being taken to the process it woke running, or with LATACK
+ * added to the device being acknowledged */
+#define LATCOUNT 0 /* samples */
+#define LATMIN 1
+#define LATAVG 2
+#define LATMAX 3
+#define LATP99 4 /* upper end of the log2 bucket holding the 99th percentile */
+#define LATACK 8
 
 /* important places */
 #define NUCLEUSSTACKPAGE 0x20001000
 #define STATUSREG 0x10400000
 
+/* multiprocessor support */
+#define MAXCPUS 8 /* most processors the nucleus will start */
+#define NCPUSADDR 0x10000500 /* machine control register: number of installed processors */
+#define PASSUPSIZE 0x10 /* each processor has its own pass up vector, this far apart */
+#define NOCPU (-1) /* p_cpu of a process that is not running */
+#define UNLOCKED 0
+#define LOCKED 1
+
+/* The BIOS saves each processor's exception state in its own slot at the
+ * start of the BIOS data page, and finds each processor's handlers in its
+ * own pass up vector. These give the ones for the processor running. */
+#define EXCSTATE ((state_PTR) (BIOSDATAPAGE + (getPRID() * sizeof(state_t))))
+#define CPUPASSUP(ID) ((passupvector_t *) (PASSUPVECTOR + ((ID) * PASSUPSIZE)))
+
 /* bit operations */
 #define ALLOFF 0x00000000
 #define IEON 0x00000004
@@ -159,6 +264,12 @@
 #define WRITETOPRINTER 11
 #define WRITETOTERMINAL 12
 #define READFROMTERMINAL 13
+#define DELAY 18 /* sleep a1 seconds on the nucleus timer wheel, see SLEEP */
+#define MAXDELAY 2000 /* longest DELAY in seconds, so that it fits in us in a cpu_t; longer ones are cut to it. Must match testers/h/tconst.h */
+#define SECOND 1000000 /* us */
+#define PSEMVIRT 19 /* P on shared semaphore a1, see sharedSems in sysSupport.c */
+#define VSEMVIRT 20 /* V on shared semaphore a1 */
+#define SHAREDSEMS 8
 #define PGTABLESIZE 32
 #define	TERM0ADDR 0x10000254
 #define  DEVICEREGISTERSBUSAREA  0x10000054 /* The device registers are located in low-memory starting at 0x1000.0054. Since this area falls in kseg0, all references are considered physical addresses and access is limited to kernel mode  */
@@ -167,7 +278,7 @@
 #define VALIDON 0x00000200
 #define GETPAGENO 0x00007000
 #define GETASID 0x00000FC0
-#define SWPSTARTADDR 0x20020000
+#define SWPSTARTADDR 0x20020000 /* the kernel image, loaded at 0x20001000, has to end below this: 124 KB for text, data and bss */
 #define MAXSTRING  128
 
 /*Support for EntryLO */
@@ -3,4 +3,6 @@
 extern void SYSCALLHandler();
 extern void stateCopy(state_PTR oldState, state_PTR newState);
 extern void otherExceptions(int reason);
+extern void terminateCurrent();
+extern void lockCurrent();
 #endif
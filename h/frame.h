@@ -0,0 +1,17 @@
+#ifndef FRAME
+#define FRAME
+
+/************************** FRAME.H ******************************
+*
+*  The externals declaration file for the nucleus page frame
+*    allocator that the pcb and semaphore descriptor pools grow from.
+*/
+
+#include "../h/types.h"
+
+extern void initFrames ();
+extern memaddr allocFrame ();
+
+/***************************************************************/
+
+#endif
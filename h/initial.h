@@ -1,4 +1,3 @@
-
 #include "../h/types.h"
 #include "../h/const.h"
 
@@ -6,9 +5,15 @@
 #define INITIAL
 extern int processCount;
 extern int softBlockCount;
-extern pcb_PTR currentProc;
-extern pcb_PTR readyQueue;
 extern int semDevices[DEVNUM];
+extern int ncpus;
+extern percpu_t cpus[MAXCPUS];
+extern spinlock_t pcbLock;
+extern spinlock_t semLock;
+
+/* the running process and its a_time at dispatch belong to the processor asking */
+#define currentProc (cpus[getPRID()].c_currentProc)
+#define startTime (cpus[getPRID()].c_startTime)
 
 
 extern int main();
@@ -7,6 +7,14 @@
 
 
 extern void IOHandler();
+extern void initDevices();
+extern void initClock();
+extern void armClock();
+extern void runDeferred();
+extern void endMasked();
+extern void endWakeup(pcb_PTR p);
+extern int intLatency(int line, int devNo, int what);
+extern unsigned int interruptCount[INTLINES];
 
 
 
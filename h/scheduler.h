@@ -3,4 +3,15 @@
 
 extern void scheduler();
 extern void loadState(state_PTR ps);
+extern void initReady();
+extern void readyProc(pcb_PTR p);
+extern pcb_PTR outReady(pcb_PTR p);
+extern void demoteProc(pcb_PTR p);
+extern void promoteProc(pcb_PTR p);
+extern int handOffSlice(pcb_PTR p, int left);
+extern pcb_PTR stopCurrent();
+extern void runProc(pcb_PTR next, int quantum);
+extern int setRealtime(pcb_PTR p, cpu_t period, cpu_t budget);
+extern void leaveRealtime(pcb_PTR p);
+extern unsigned int realtimeMisses();
 #endif
\ No newline at end of file
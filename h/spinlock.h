@@ -0,0 +1,18 @@
+#ifndef SPINLOCK
+#define SPINLOCK
+
+/************************* SPINLOCK.H *****************************
+*
+*  The externals declaration file for the spinlocks the processors
+*    use to share nucleus data structures.
+*
+*/
+
+#include "../h/types.h"
+
+extern void spinLock (spinlock_t *l);
+extern void spinUnlock (spinlock_t *l);
+
+/***************************************************************/
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef SYSSTATSH
+#define SYSSTATSH
+
+/************************** SYSSTATS.H ******************************
+*
+*  The externals declaration file for the nucleus syscall counters and
+*    latency histograms. Built with SYSSTATS FALSE the hooks expand to
+*    nothing.
+*/
+
+#include "../h/types.h"
+
+#if SYSSTATS
+extern void beginSyscall (int number);
+extern void endSyscall ();
+extern int dumpSysStats ();
+#define BEGINSYSCALL(N)	beginSyscall(N)
+#define ENDSYSCALL()	endSyscall()
+#define STATSDUMP()	dumpSysStats()
+#else
+#define BEGINSYSCALL(N)
+#define ENDSYSCALL()
+#define STATSDUMP()
+#endif
+
+/***************************************************************/
+
+#endif
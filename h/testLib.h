@@ -0,0 +1,23 @@
+#ifndef TESTLIB
+#define TESTLIB
+
+/************************** TESTLIB.H ******************************
+*
+*  The externals declaration file for what the nucleus tests linked in
+*    place of initProc.c share: printing on terminal 0 and starting
+*    children on stack slots below test()'s own stack.
+*/
+
+#include "../h/types.h"
+
+#define RECVD		5	/* terminal status of a character transmitted */
+
+extern void print (char *msg);
+extern void printNum (unsigned int n);
+extern void initSpawn (int stackBytes);
+extern int trySpawn (void (*fn)(), int slot, int arg);
+extern void spawn (void (*fn)(), int slot, int arg);
+
+/***************************************************************/
+
+#endif
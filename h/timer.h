@@ -0,0 +1,20 @@
+#ifndef TIMER
+#define TIMER
+
+/************************** TIMER.H ******************************
+*
+*  The externals declaration file for the nucleus timer wheel that
+*    SLEEP (SYS28) and the support level DELAY park processes on.
+*/
+
+#include "../h/types.h"
+
+extern void initTimers ();
+extern void addSleeper (pcb_PTR p, cpu_t us);
+extern void cancelSleeper (pcb_PTR p);
+extern void expireTimers (cpu_t now);
+extern int nextTimer (cpu_t *when);
+
+/***************************************************************/
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef TRACEH
+#define TRACEH
+
+/************************** TRACE.H ******************************
+*
+*  The event trace ring the nucleus logs into when built with TRACE
+*    TRUE, laid out the same for the nucleus and for the host side
+*    decoder (bench/traceDecode.c). Built with TRACE FALSE the hooks
+*    expand to nothing.
+*/
+
+#include "../h/const.h"
+
+/* event types, e_a and e_b are what each logs */
+#define TRDISPATCH	1	/* pcb, time slice in us */
+#define TRBLOCK		2	/* semaphore, pcb */
+#define TRUNBLOCK	3	/* semaphore, pcb */
+#define TRINTERRUPT	4	/* line, device */
+#define TRSYSENTER	5	/* syscall number, pcb */
+#define TRSYSEXIT	6	/* syscall number, v0 */
+#define TRPAGEFAULT	7	/* asid, page */
+#define TREVICT		8	/* asid, page of the victim */
+#define TRTYPES		9
+
+typedef struct traceevent_t {
+	unsigned int e_tod;	/* TOD low word in clock ticks, not us */
+	unsigned int e_type;
+	unsigned int e_a;
+	unsigned int e_b;
+} traceevent_t;
+
+typedef struct tracebuf_t {
+	unsigned int t_magic;	/* TRACEMAGIC, so a memory dump can be searched for it */
+	unsigned int t_timescale;	/* clock ticks per us */
+	unsigned int t_size;	/* TRACESIZE */
+	unsigned int t_ncpus;
+	unsigned int t_next[MAXCPUS];	/* events each processor ever logged, its ring holds the last t_size */
+	unsigned int t_ring[MAXCPUS];	/* address of the frame holding each processor's ring of t_size events */
+} tracebuf_t;
+
+#if TRACE
+extern tracebuf_t traceBuf;
+extern void initTrace ();
+extern void traceEvent (unsigned int type, unsigned int a, unsigned int b);
+extern void traceSysExit (unsigned int v0);
+extern void dumpTrace ();
+#define TRACEEVENT(T, A, B)	traceEvent((T), (unsigned int) (A), (unsigned int) (B))
+#define TRACESYSEXIT(V)	traceSysExit((unsigned int) (V))
+#define TRACEINIT()	initTrace()
+#define TRACEDUMP()	dumpTrace()
+#else
+#define TRACEEVENT(T, A, B)
+#define TRACESYSEXIT(V)
+#define TRACEINIT()
+#define TRACEDUMP()
+#endif
+
+/***************************************************************/
+
+#endif
@@ -119,20 +119,55 @@ typedef struct support_t
 
 } support_t;
 
+/* What the nucleus keeps on a process besides its links: cpu time
+ * accounting, its time slice and stride weight, the real-time class,
+ * wakeup latency and sleep. It is read on dispatch, on the way out of a
+ * processor and by the syscalls that report it, never on a queue walk, so
+ * it sits in a cold slot next to the processor state, see pcb.c. */
+typedef struct pcbacct_t{
+	int a_killed; /* TRUE once terminated while running on another processor */
+	cpu_t a_time; /* cpu time used by proc, user and nucleus on its behalf */
+	cpu_t a_sysTime; /* the part of a_time spent in the nucleus */
+	cpu_t a_intTime; /* interrupt handling while it ran, not in a_time */
+	int a_quantum; /* time slice at level 0 */
+	unsigned int a_dispatches; /* times it was given a processor */
+	int a_weight; /* share of the cpu under stride scheduling, 1 to MAXWEIGHT */
+/* real-time class, a_rtPeriod is 0 for a best effort process */
+	cpu_t a_rtPeriod; /* us between deadlines */
+	cpu_t a_rtBudget; /* us of cpu promised every period */
+	int a_rtLeft; /* us of budget left before a_deadline */
+	cpu_t a_deadline; /* TOD of the current deadline */
+	unsigned int a_rtMisses; /* deadlines missed */
+	cpu_t a_wakeTOD; /* TOD of the device interrupt that woke it, 0 once it has run since */
+	struct devdesc_t *a_wakeDev; /* that device */
+	unsigned int a_sleepTick; /* timer wheel tick it sleeps until, 0 if not asleep */
+} pcbacct_t;
+
 typedef struct pcb_t
 {
+    /* Hot fields: everything a walk of a process queue, the process tree
+     * or the ASL touches is packed together ahead of the cold state. */
     struct pcb_t
         *p_next, /* pointer to next entry */
         *p_prev, /* pointer to prev entry */
 
         *p_prnt, /* pointer to parent */
         *p_child, /* pointer to 1st child */
-        *p_sib; /* pointer to sibling */
-    	state_t p_s; /* processor state */
-    	cpu_t p_time; /* cpu time used by proc */
+        *p_sib, /* pointer to sibling */
+        *p_sibPrev, /* pointer to previous sibling */
+
+        **p_queue; /* tail pointer of the queue p is on, NULL if none */
+    	int p_cpu; /* processor running it, NOCPU if none */
     	int *p_semAdd; /* pointer to sema4 in which process blocked */
+    	int p_level; /* ready level, 0 is the highest (always 0 under round robin) */
+    	unsigned int p_pass; /* stride scheduling virtual time, lowest runs next, compared on a queue walk */
     /* support layer information */
     	support_t *p_supportStruct; /* ptr to support struct */
+    /* Cold fields: the processor state and the rest of what the nucleus
+     * keeps on the process live in separate slots, one per pcb, touched
+     * on a context switch and by the syscalls that report them. */
+    	state_t *p_s; /* processor state */
+    	pcbacct_t *p_acct; /* accounting, scheduling class and sleep */
 } pcb_t, *pcb_PTR;
 
 typedef struct semd_t{
@@ -147,5 +182,52 @@ typedef struct swap_t{
 	pteEntry_t * sw_pte;
 } swap_t;
 
+/* Latencies of one kind after a device interrupt, in us, see interrupts.c */
+typedef struct latency_t{
+	unsigned int l_count; /* samples */
+	unsigned int l_min;
+	unsigned int l_max;
+	unsigned int l_sum;
+	unsigned int l_hist[STATBUCKETS]; /* log2 us buckets, as in sysStats.c */
+} latency_t;
+
+/* What IOHandler() needs to service one device, see initDevices() in interrupts.c */
+typedef struct devdesc_t{
+	device_t *d_reg; /* its device register */
+	int *d_sem; /* its semaphore in semDevices[], a terminal's transmitter one */
+	int *d_recvSem; /* a terminal's receiver semaphore, NULL for other devices */
+	int d_class; /* interrupt line, DISKINT to TERMINT */
+	int d_devNo; /* device number on that line */
+	volatile unsigned int d_head; /* completions the top half queued, see runDeferred() */
+	volatile unsigned int d_tail; /* completions the bottom half took */
+	unsigned int d_ring[DEVRING]; /* their statuses, DEVRINGRECV set for a terminal receiver */
+	cpu_t d_ringTOD[DEVRING]; /* and the TODs their interrupts were taken */
+	latency_t d_ackLat; /* interrupt taken to acknowledged */
+	latency_t d_runLat; /* interrupt taken to the process it woke dispatched */
+} devdesc_t;
+
+/* A busy waiting lock shared between processors, taken with CAS */
+typedef volatile unsigned int spinlock_t;
+
+/* What each processor keeps to itself, see cpus[] in initial.c */
+typedef struct percpu_t{
+	pcb_t *c_currentProc; /* process running on this processor, NULL if idle */
+	cpu_t c_startTime; /* a_time of c_currentProc when it was dispatched */
+	cpu_t c_markTOD; /* TOD of the last nucleus entry or exit, see account.c */
+	int c_bucket; /* what the time since c_markTOD is charged as */
+	memaddr c_stackTop; /* top of this processor's nucleus stack */
+	int c_steals; /* times the scheduler took processes from another processor's ready queue */
+	int c_migrations; /* processes moved here by those steals */
+	int c_idle; /* TRUE while waiting for something to run */
+	cpu_t c_idleSince; /* TOD the current wait started */
+	cpu_t c_idleTime; /* total time spent waiting */
+	int c_idlePoll; /* how long the next wait may last before looking for work again */
+	unsigned int c_intEntries; /* times IOHandler() ran here */
+	unsigned int c_intServiced; /* interrupts it serviced, c_intServiced / c_intEntries per entry */
+	unsigned int c_intBatchMax; /* most interrupts serviced in one entry */
+	cpu_t c_intSince; /* TOD an interrupt was taken with interrupts still off since, 0 if none */
+	cpu_t c_maskedMax; /* longest an interrupt kept them off */
+} percpu_t;
+
 
 #endif
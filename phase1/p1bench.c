@@ -0,0 +1,80 @@
+/************ P1BENCH.C ************/
+/*
+ * Host side throughput benchmark for the phase 1 queue and ASL modules,
+ * built with make hostbench. It keeps "size" pcbs on one process queue
+ * and times rotating it with removeProcQ/insertProcQ, then blocks one pcb
+ * on each of "size" semaphores and times a P/V style
+ * removeBlocked/insertBlocked pair on each of them in turn. Phase 1 pools
+ * are static, so size cannot exceed MAXPROC.
+ *
+ *   usage: p1bench [size] [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/pcb.h"
+#include "../h/asl.h"
+
+HIDDEN int sems[MAXPROC];
+HIDDEN pcb_PTR procs[MAXPROC];
+
+HIDDEN double nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    int size = (argc > 1) ? atoi(argv[1]) : MAXPROC;
+    long rounds = (argc > 2) ? atol(argv[2]) : 10000000;
+    pcb_PTR queue;
+    double start, queueNs, aslNs;
+    long r;
+    int i;
+
+    if (size < 1 || size > MAXPROC) {
+        fprintf(stderr, "size must be between 1 and %d\n", MAXPROC);
+        return 1;
+    }
+
+    initPcbs();
+    initASL();
+    for (i = 0; i < size; i++) {
+        procs[i] = allocPcb();
+    }
+
+    queue = mkEmptyProcQ();
+    for (i = 0; i < size; i++) {
+        insertProcQ(&queue, procs[i]);
+    }
+    start = nowNs();
+    for (r = 0; r < rounds; r++) {
+        insertProcQ(&queue, removeProcQ(&queue));
+    }
+    queueNs = nowNs() - start;
+    while (removeProcQ(&queue) != NULL);
+
+    for (i = 0; i < size; i++) {
+        if (insertBlocked(&sems[i], procs[i])) {
+            fprintf(stderr, "ran out of semaphore descriptors at %d\n", i);
+            return 1;
+        }
+    }
+    start = nowNs();
+    for (r = 0; r < rounds; r++) {
+        i = r % size;
+        insertBlocked(&sems[i], removeBlocked(&sems[i]));
+    }
+    aslNs = nowNs() - start;
+
+    printf("p1bench size=%d rounds=%ld remove+insertProcQ=%.1fns (%.2fM/s) "
+           "remove+insertBlocked=%.1fns (%.2fM/s)\n",
+           size, rounds, queueNs / rounds, rounds / queueNs * 1e3,
+           aslNs / rounds, rounds / aslNs * 1e3);
+    return 0;
+}
@@ -52,7 +52,7 @@ pcb_t *allocPcb(){
 		p_temp -> p_sibPrev = NULL;
 		/* The below assignments are process status information */
 		p_temp -> p_s = NULL;
-		p_temp -> p_time = 0;
+		p_temp -> p_acct = NULL;
 		p_temp -> p_semAdd =NULL;
 		/* The below assignments are support layer information */
 		p_temp -> p_supportStruct = NULL;
@@ -0,0 +1,62 @@
+/************ ACCOUNT.C ************/
+/*
+ * CPU time accounting.
+ *
+ * Each processor keeps a mark: the TOD of its last nucleus entry or exit
+ * and the bucket the time since then belongs to. Every transition charges
+ * the time since the mark to the running process and starts a new mark:
+ * entering the nucleus closes a stretch of user time, going back to the
+ * process (loadState or a pass up) closes a stretch of nucleus time. The
+ * nucleus time is ACCTSYS if the process asked for it (a syscall or a
+ * trap) and ACCTINT if an interrupt took it. a_time is user plus ACCTSYS
+ * time, which is what GETCPUTIME reports; interrupt time is kept apart in
+ * a_intTime, so a process is no longer charged for handling other
+ * processes' devices. Nucleus time with no process running (the
+ * scheduler, idle waits) is charged to nobody.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/initial.h"
+#include "../h/account.h"
+#include "../h/libumps.h"
+
+
+/* Charge the running process, if any, for the time since this processor's
+ * mark and start a new mark in bucket. */
+void chargeCurrent(int bucket){
+    percpu_t *cpu = &cpus[getPRID()];
+    pcb_PTR p = cpu->c_currentProc;
+    cpu_t now, spent;
+    STCK(now);
+    spent = now - cpu->c_markTOD;
+    if(p != NULL){
+        if(cpu->c_bucket == ACCTINT){
+            p->p_acct->a_intTime += spent;
+        } else {
+            p->p_acct->a_time += spent;
+            if(cpu->c_bucket == ACCTSYS){
+                p->p_acct->a_sysTime += spent;
+            }
+        }
+    }
+    cpu->c_markTOD = now;
+    cpu->c_bucket = bucket;
+}
+
+
+/* p's time in bucket so far, up to the last mark. */
+cpu_t cpuTime(pcb_PTR p, int bucket){
+    switch(bucket){
+    case ACCTUSER:
+        return p->p_acct->a_time - p->p_acct->a_sysTime;
+    case ACCTSYS:
+        return p->p_acct->a_sysTime;
+    case ACCTINT:
+        return p->p_acct->a_intTime;
+    case ACCTDISPATCHES:
+        return p->p_acct->a_dispatches;
+    default:
+        return p->p_acct->a_time;
+    }
+}
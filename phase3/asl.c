@@ -1,17 +1,50 @@
 
 #include <stdio.h>
-#include <limits.h>
 #include "../h/pcb.h"
 #include "../h/asl.h"
-HIDDEN semd_t *semd_h, *semdFree_h = NULL;
+#include "../h/frame.h"
+#include "../h/trace.h"
+
+/* The ASL is a hash table of semaphore descriptors keyed on s_semAdd.
+ * Each bucket is a NULL terminated chain sorted in ascending s_semAdd
+ * order, so a lookup only walks the few descriptors that share a bucket.
+ */
+HIDDEN semd_t *semdHash[SEMDHASHSIZE];
+HIDDEN semd_t *semdFree_h = NULL;
+HIDDEN semd_t *semdSlab; /* next never used semd in the newest slab frame */
+HIDDEN int semdSlabLeft; /* never used semds left in that frame */
+
+/* Semaphores are word aligned and the device semaphores are contiguous,
+ * so dropping the low two bits spreads them over consecutive buckets. */
+#define SEMDHASH(A)	((((memaddr) (A)) >> SHIFT) & (SEMDHASHSIZE - 1))
+
+
+/* Like carvePcb() in pcb.c: take the next never used semd of the newest
+ * slab, grabbing a whole new frame when it runs out. */
+HIDDEN semd_t *carveSem()
+{
+    if (semdSlabLeft == 0)
+    {
+        memaddr frame = allocFrame();
+        if (frame == (memaddr) NULL)
+            return NULL;
+        semdSlab = (semd_t *) frame;
+        semdSlabLeft = PAGESIZE / sizeof(semd_t);
+    }
+    semdSlabLeft--;
+    return semdSlab++;
+}
 
 
 HIDDEN semd_t *allocSem()
 {
-    if (semdFree_h == NULL)
-        return NULL;
     semd_t *freed = semdFree_h;
-    semdFree_h = semdFree_h->s_next;
+    if (freed == NULL)
+        freed = carveSem();
+    else
+        semdFree_h = semdFree_h->s_next;
+    if (freed == NULL)
+        return NULL;
     freed->s_next = NULL;
     freed->s_procQ = mkEmptyProcQ();
     freed->s_semAdd = NULL; 
@@ -27,41 +60,44 @@ HIDDEN void deallocSem(semd_t *sem)
     sem->s_semAdd = NULL;
 }
 
-HIDDEN semd_t *search(int *semAdd)
+/* Return the link that points at the descriptor for semAdd, or at the
+ * place in its bucket where that descriptor would be inserted. */
+HIDDEN semd_t **search(int *semAdd)
 {
-    semd_t *current = semd_h;
+    semd_t **link = &semdHash[SEMDHASH(semAdd)];
 
-    while (semAdd > (current->s_next->s_semAdd))
+    while (*link != NULL && semAdd > (*link)->s_semAdd)
     {
-        current = current->s_next;
+        link = &((*link)->s_next);
     }
 
-    return current;
+    return link;
 }
 
 
 void initASL()
 {
-    static semd_t semdTable[MAXPROC + 2];
+    static semd_t semdTable[MAXPROC];
     int i;
+    semdSlabLeft = 0;
+    for (i = 0; i < SEMDHASHSIZE; i++)
+    {
+        semdHash[i] = NULL;
+    }
     for (i = 0; i < MAXPROC; i++)
     {
-        deallocSem(&semdTable[i + 1]);
+        deallocSem(&semdTable[i]);
     }
-    semd_h = (&semdTable[0]);
-    semd_h->s_semAdd = (int *)INT_MIN;
-    semd_h->s_next = (&semdTable[MAXPROC + 1]);
-    semd_h->s_next->s_semAdd = (int *)INT_MAX;
 }
 
 
 int insertBlocked(int *semAdd, pcb_PTR p)
 {
-    semd_t *parent = search(semAdd);
-    if (parent->s_next->s_semAdd == semAdd)
+    semd_t **link = search(semAdd);
+    if (*link != NULL && (*link)->s_semAdd == semAdd)
     {
         p->p_semAdd = semAdd;
-        insertProcQ(&(parent->s_next->s_procQ), p);
+        insertProcQ(&((*link)->s_procQ), p);
     }
     else
     {
@@ -74,29 +110,32 @@ int insertBlocked(int *semAdd, pcb_PTR p)
         sem->s_procQ = mkEmptyProcQ();
         p->p_semAdd = semAdd;
         insertProcQ(&(sem->s_procQ), p);
-        sem->s_next = parent->s_next;
-        parent->s_next = sem;
+        sem->s_next = *link;
+        *link = sem;
     }
+    TRACEEVENT(TRBLOCK, semAdd, p);
     return FALSE;
 }
 
 
 pcb_PTR removeBlocked(int *semdAdd)
 {
-    semd_t *parent = search(semdAdd);
-    if (parent->s_next->s_semAdd == semdAdd)
+    semd_t **link = search(semdAdd);
+    if (*link != NULL && (*link)->s_semAdd == semdAdd)
     {
-        pcb_PTR remove = removeProcQ(&(parent->s_next->s_procQ));
+        pcb_PTR remove = removeProcQ(&((*link)->s_procQ));
         if (remove == NULL)
         {
             return NULL;
         }
-        if (emptyProcQ(parent->s_next->s_procQ))
+        remove->p_semAdd = NULL;
+        if (emptyProcQ((*link)->s_procQ))
         {
-            semd_t *removed = parent->s_next;
-            parent->s_next = parent->s_next->s_next;
+            semd_t *removed = *link;
+            *link = removed->s_next;
             deallocSem(removed);
         }
+        TRACEEVENT(TRUNBLOCK, semdAdd, remove);
         return remove;
     }
     return NULL;
@@ -106,19 +145,20 @@ pcb_PTR removeBlocked(int *semdAdd)
 pcb_PTR outBlocked(pcb_PTR p)
 {
     int *semdAdd = p->p_semAdd;
-    semd_t *parent = search(semdAdd);
-    if (parent->s_next->s_semAdd == semdAdd)
+    semd_t **link = search(semdAdd);
+    if (*link != NULL && (*link)->s_semAdd == semdAdd)
     {
-        pcb_PTR remove = outProcQ(&(parent->s_next->s_procQ), p);
+        pcb_PTR remove = outProcQ(&((*link)->s_procQ), p);
         if (remove == NULL)
         {
             return NULL;
         }
-        
-        if (emptyProcQ(parent->s_next->s_procQ))
+        remove->p_semAdd = NULL;
+
+        if (emptyProcQ((*link)->s_procQ))
         {
-            semd_t *removed = parent->s_next;
-            parent->s_next = parent->s_next->s_next;
+            semd_t *removed = *link;
+            *link = removed->s_next;
             deallocSem(removed);
         }
         return remove;
@@ -129,10 +169,10 @@ pcb_PTR outBlocked(pcb_PTR p)
 
 pcb_PTR headBlocked(int *semAdd)
 {
-    semd_t *temp = search(semAdd);
-    if (temp->s_next->s_semAdd == semAdd)
+    semd_t **link = search(semAdd);
+    if (*link != NULL && (*link)->s_semAdd == semAdd)
     {
-        return headProcQ(temp->s_next->s_procQ);
+        return headProcQ((*link)->s_procQ);
     }
     return NULL;
 }
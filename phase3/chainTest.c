@@ -0,0 +1,74 @@
+/************ chainTest.c ************/
+/* Nucleus stress test for SYS2 on deep process trees.
+ *
+ * Linked in place of initProc.c (make chain) so test() here is the first
+ * process. Each round it grows a linear chain of processes, every link
+ * creating the next with SYS1, until SYS1 fails because the pcb pool
+ * cannot grow any more or CHAINMAX links exist (their stacks have to fit
+ * in the PROCSTACKFRAMES frames at the top of RAM). The head of the chain
+ * then terminates itself with SYS2,
+ * which has to tear the whole chain down, and test() reports how long
+ * that took on terminal 0. Finally test() terminates, which HALTs.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/testLib.h"
+#include "../h/libumps.h"
+
+#define CHAINROUNDS	5
+#define CHAINSTACK	1024	/* stack bytes given to each link */
+#define CHAINMAX	100	/* links whose stacks fit below test()'s own */
+
+HIDDEN int chainBuilt = 0;	/* V'd by the last link once the chain is complete */
+HIDDEN int chainKilled = 0;	/* V'd by the head just before its SYS2 */
+HIDDEN int chainHold = 0;	/* every other link waits here until it is killed */
+HIDDEN int chainDepth;		/* number of links in the current chain */
+HIDDEN cpu_t killStart;	/* TOD just before the head issued SYS2 */
+
+HIDDEN void chainLink(int depth)
+{
+	if (depth == CHAINMAX || trySpawn(chainLink, depth + 1, depth + 1) != 0) {
+		/* Out of stack room or pcbs: this is the last link. */
+		chainDepth = depth;
+		SYSCALL(VERHOGEN, (int) &chainBuilt, 0, 0);
+	}
+	if (depth > 1) {
+		SYSCALL(PASSEREN, (int) &chainHold, 0, 0);
+	}
+
+	/* The head: wait for the chain, then kill it with interrupts off so
+	 * nothing runs between the timestamp and the SYS2. */
+	SYSCALL(PASSEREN, (int) &chainBuilt, 0, 0);
+	setSTATUS(getSTATUS() & ~IECON);
+	STCK(killStart);
+	SYSCALL(VERHOGEN, (int) &chainKilled, 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+void test()
+{
+	cpu_t killEnd;
+	int round;
+
+	initSpawn(CHAINSTACK);
+
+	print("chainTest: SYS2 on a chain as deep as the pcb pool and stacks allow\n");
+	for (round = 0; round < CHAINROUNDS; round++) {
+		if (trySpawn(chainLink, 1, 1) != 0) {
+			print("chainTest: could not create the chain head\n");
+			PANIC();
+		}
+		SYSCALL(PASSEREN, (int) &chainKilled, 0, 0);
+		STCK(killEnd);
+
+		print("chainTest: depth ");
+		printNum(chainDepth);
+		print(" SYS2 ");
+		printNum(killEnd - killStart);
+		print(" us\n");
+	}
+
+	print("chainTest: done\n");
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
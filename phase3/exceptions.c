@@ -5,15 +5,18 @@
 #include "../h/asl.h"
 #include "../h/scheduler.h"
 #include "../h/exceptions.h"
+#include "../h/interrupts.h"
 #include "../h/initial.h"
+#include "../h/spinlock.h"
+#include "../h/account.h"
+#include "../h/sysStats.h"
+#include "../h/trace.h"
+#include "../h/timer.h"
 #include "/usr/include/umps3/umps/libumps.h"
 
-extern pcb_PTR currentProc;
-extern pcb_PTR readyQueue;
 extern int processCount;
 extern int softBlockCount;
 extern int semDevices[DEVNUM];
-extern cpu_t startTOD;
 extern int* clockSem;
 extern void loadState(state_PTR ps);
 
@@ -27,8 +30,18 @@ void waitForIO(state_PTR curr);
 void getCPUTime(state_PTR curr);
 void waitForClock(state_PTR curr);
 void getSupport(state_PTR curr);
+void setWeight(state_PTR curr);
+void declareRealtime(state_PTR curr);
+void getRtStats(state_PTR curr);
+void getCPUStats(state_PTR curr);
+void setQuantum(state_PTR curr);
+void dumpStats(state_PTR curr);
+void getIntLatency(state_PTR curr);
+void sleepFor(state_PTR curr);
 
 void passUpOrDie(state_PTR curr, int exception);
+void terminateCurrent();
+void lockCurrent();
 void otherExceptions();
 
 void stateCopy(state_PTR oldState, state_PTR newState);
@@ -36,7 +49,7 @@ void stateCopy(state_PTR oldState, state_PTR newState);
 
 void SYSCALLHandler(){
     /* Save the processor state. */
-    state_PTR ps = (state_PTR) BIOSDATAPAGE; 
+    state_PTR ps = EXCSTATE; 
     ps->s_pc = ps->s_pc+PCINC;
     ps->s_t9 = ps->s_pc+PCINC;
     
@@ -47,6 +60,8 @@ void SYSCALLHandler(){
     }
 
     int syscallNumber = (ps->s_a0);
+    BEGINSYSCALL(syscallNumber);
+    TRACEEVENT(TRSYSENTER, syscallNumber, currentProc);
     switch (syscallNumber)
     {
     case CREATEPROCESS:{ /* if syscallNumber == 1 */
@@ -55,7 +70,7 @@ void SYSCALLHandler(){
     
     case TERMINATEPROCESS:{ /* if syscallNumber == 2 */
         if(currentProc != NULL){
-            terminateProc(currentProc);
+            terminateCurrent();
         }
         scheduler();
         break;}
@@ -83,6 +98,38 @@ void SYSCALLHandler(){
     case GETSUPPORTPTR:{ /* if syscallNumber == 8 */
         getSupport(ps);
         break;}
+
+    case SETWEIGHT:{ /* if syscallNumber == 21 */
+        setWeight(ps);
+        break;}
+
+    case SETREALTIME:{ /* if syscallNumber == 22 */
+        declareRealtime(ps);
+        break;}
+
+    case GETRTSTATS:{ /* if syscallNumber == 23 */
+        getRtStats(ps);
+        break;}
+
+    case GETCPUSTATS:{ /* if syscallNumber == 24 */
+        getCPUStats(ps);
+        break;}
+
+    case SETQUANTUM:{ /* if syscallNumber == 25 */
+        setQuantum(ps);
+        break;}
+
+    case DUMPSYSSTATS:{ /* if syscallNumber == 26 */
+        dumpStats(ps);
+        break;}
+
+    case GETINTLATENCY:{ /* if syscallNumber == 27 */
+        getIntLatency(ps);
+        break;}
+
+    case SLEEP:{ /* if syscallNumber == 28 */
+        sleepFor(ps);
+        break;}
     
     default:{
         passUpOrDie(ps, GENERALEXCEPT); 
@@ -92,41 +139,53 @@ void SYSCALLHandler(){
 
 /* "The sys1 service is requested by the calling process by placing the value 1 in a0, a pointer to a processor state in a1, a pointer to a support struct in a2, and then executing the syscall instruction." p.25 pandos*/ 
 void createProc(state_PTR oldState){
+    spinLock(&pcbLock);
+    if(currentProc->p_acct->a_killed){ /* a dead parent must not leave children behind */
+        spinUnlock(&pcbLock);
+        terminateCurrent();
+    }
     pcb_PTR child = allocPcb();
     int returnStatus = -1;
     if(child != NULL){
         insertChild(currentProc, child);
-        insertProcQ(&readyQueue, child);
-        stateCopy((state_PTR) (oldState->s_a1), &(child->p_s));
+        stateCopy((state_PTR) (oldState->s_a1), child->p_s);
         if(oldState->s_a2 != 0 || oldState->s_a2 != NULL){
             child->p_supportStruct = (support_t *) oldState->s_a2;
         } else {
             child->p_supportStruct = NULL;
         }
         processCount++;
+        /* only once its state is in place: another processor may run it at once */
+        readyProc(child);
         returnStatus = 0;
     }
-    currentProc->p_s.s_v0 = returnStatus;
+    spinUnlock(&pcbLock);
+    oldState->s_v0 = returnStatus;
     loadState(oldState);   
 }
 
-void terminateProc(pcb_PTR parentProc){
-    while(!emptyChild(parentProc)){
-	    terminateProc(removeChild(parentProc));
+/* Take a single pcb, which has no children left, off whatever queue it is
+ * on, undo its effect on the semaphore it was blocked on, and free it.
+ * Called with pcbLock and semLock held. */
+HIDDEN void reapProc(pcb_PTR proc){
+    processCount--;
+    leaveRealtime(proc);
+    /* Off the ready queues first: a processor claims a process as it takes
+     * it off them, so once it is not there p_cpu can be trusted. */
+    if(outReady(proc) != NULL){
+        freePcb(proc);
+        return;
     }
-
-    if(currentProc == parentProc){
-	    outChild(parentProc);
-    } 
-
-    if(parentProc->p_semAdd == NULL){
-	    outProcQ(&readyQueue, parentProc);
+    if(proc->p_cpu != NOCPU){
+        /* Running on another processor, which still uses it: mark it, and
+         * that processor frees it the next time it enters the nucleus. */
+        proc->p_acct->a_killed = TRUE;
+        return;
     }
-   else {
-        
-        pcb_PTR removed = outBlocked(parentProc);
+    if(proc->p_semAdd != NULL) {
+        int* semdAdd = proc->p_semAdd;
+        pcb_PTR removed = outBlocked(proc);
         if(removed != NULL){
-        	int* semdAdd = removed->p_semAdd;
             if( semdAdd >= &semDevices[ZERO] && semdAdd <= &semDevices[DEVNUM]){
                 softBlockCount--;
             } else {
@@ -135,91 +194,269 @@ void terminateProc(pcb_PTR parentProc){
         }
         
     }
-    freePcb(parentProc);
-    processCount--;
+    if(proc->p_acct->a_sleepTick != 0){
+        cancelSleeper(proc);
+    }
+    freePcb(proc);
+}
+
+/* Kill rootProc and all of its progeny. The tree is torn down post-order
+ * by walking the pcb links themselves: descend to a leaf, reap it, and go
+ * back up to its parent. This runs on the nucleus stack page, so it must
+ * not recurse once per generation. */
+void terminateProc(pcb_PTR rootProc){
+    outChild(rootProc);
+    pcb_PTR proc = rootProc;
+    while(proc != NULL){
+        while(!emptyChild(proc)){
+            proc = proc->p_child;
+        }
+        pcb_PTR parent = proc->p_prnt;
+        outChild(proc);
+        reapProc(proc);
+        proc = parent;
+    }
     /* we call the scheduler in the switch case statements */
 }
+
+/* Terminate the process running on this processor and its progeny, then
+ * run something else. If another processor already terminated it (see
+ * reapProc) its progeny are gone and all that is left is to free it. */
+void terminateCurrent(){
+    spinLock(&pcbLock);
+    spinLock(&semLock);
+    pcb_PTR proc = stopCurrent();
+    if(proc->p_acct->a_killed){
+        freePcb(proc);
+    } else {
+        terminateProc(proc);
+    }
+    spinUnlock(&semLock);
+    spinUnlock(&pcbLock);
+    scheduler();
+}
+
+/* Take semLock before taking the running process off this processor. If it
+ * was terminated from another processor meanwhile, finish it off instead. */
+void lockCurrent(){
+    spinLock(&semLock);
+    if(currentProc->p_acct->a_killed){
+        spinUnlock(&semLock);
+        terminateCurrent();
+    }
+}
 /* the wait() operation: When a process is waiting for IO and we want another process to execute while we're waiting.   */
 void passeren(state_PTR oldState){
      int* semdAdd = (int*) oldState->s_a1; 
+    lockCurrent();
     (*semdAdd)--; /* decrement the number of processes waiting on this semaphore to indicate the increased magnitude of process waiting on the semaphore.*/
     if((*semdAdd)<0){ /* if semdAdd is negative then there are process waiting on the semaphore. */
-	stateCopy(oldState, &(currentProc->p_s)); /* save the currentProc state, then we'll insert the currentProc on the asl */
-        insertBlocked(semdAdd, currentProc); 
+	stateCopy(oldState, currentProc->p_s); /* save the currentProc state, then we'll insert the currentProc on the asl */
+        insertBlocked(semdAdd, stopCurrent()); 
+        spinUnlock(&semLock);
         scheduler();
     }
+    spinUnlock(&semLock);
     loadState(oldState);   
 }
 
-/* the signal() operation */
+/* the signal() operation. With HANDOFF, the process it wakes runs at once
+ * for whatever is left of the caller's quantum, and the caller goes to the
+ * back of the readyQueue, so a wakeup does not wait behind every ready
+ * process. handOffSlice() keeps that to a process of the caller's class. */
 void ver(state_PTR oldState){
     int* semdAdd = (int*)oldState->s_a1;
+    lockCurrent();
     (*semdAdd)++;
     if((*semdAdd)<=0){
         pcb_PTR temp = removeBlocked(semdAdd);
         if(temp != NULL) {
-            insertProcQ(&readyQueue, temp);
+#if HANDOFF
+            int left = handOffSlice(temp, (int) getTIMER());
+            if(left > 0){
+                stateCopy(oldState, currentProc->p_s);
+                readyProc(stopCurrent());
+                temp->p_cpu = getPRID(); /* claimed before semLock goes, see reapProc */
+                spinUnlock(&semLock);
+                runProc(temp, left);
+            }
+#endif
+            readyProc(temp);
         }
     }
+    spinUnlock(&semLock);
     loadState(oldState);
 }
 
 
 void waitForIO(state_PTR oldState){
-    stateCopy(oldState, &(currentProc->p_s));
+    stateCopy(oldState, currentProc->p_s);
     int lineNo = oldState->s_a1;
     int devNo = oldState->s_a2;
     int waitterm = oldState->s_a3;
     int devi = ((lineNo - 3 + waitterm) * DEVPERINT + devNo);
+    lockCurrent();
     semDevices[devi]--;
     softBlockCount++;
-    insertBlocked(&(semDevices[devi]), currentProc);
-    currentProc = NULL;
+    pcb_PTR proc = stopCurrent();
+    promoteProc(proc);
+    insertBlocked(&(semDevices[devi]), proc);
+    spinUnlock(&semLock);
     scheduler();
 }
 
 
 void getCPUTime(state_PTR oldState){
-    stateCopy(oldState, &(currentProc->p_s));
-    cpu_t time;
-    STCK(time);
-    time -= startTOD;
-    currentProc->p_time += time;
-    currentProc->p_s.s_v0 = currentProc->p_time;
-    loadState(&currentProc->p_s);   
+    stateCopy(oldState, currentProc->p_s);
+    chargeCurrent(ACCTSYS); /* bring a_time up to now */
+    currentProc->p_s->s_v0 = currentProc->p_acct->a_time;
+    loadState(currentProc->p_s);   
 }
 
 
 void waitForClock(state_PTR oldState){
-    stateCopy(oldState, &(currentProc->p_s));
+    stateCopy(oldState, currentProc->p_s);
+    lockCurrent();
     (*clockSem)--;
     if((*clockSem)<0){
-        insertBlocked(clockSem, currentProc);
+        pcb_PTR proc = stopCurrent();
+        promoteProc(proc);
+        insertBlocked(clockSem, proc);
         softBlockCount++;
-        currentProc = NULL;
+        armClock(); /* TICKLESS: make sure the next tick comes */
+        spinUnlock(&semLock);
         scheduler();
     }
+    spinUnlock(&semLock);
+}
+
+
+/* Sleep for a1 microseconds, rounded up to whole timer wheel ticks. v0
+ * is 0, or -1 without sleeping if a1 is negative. */
+void sleepFor(state_PTR oldState){
+    stateCopy(oldState, currentProc->p_s);
+    if(oldState->s_a1 <= 0){
+        currentProc->p_s->s_v0 = (oldState->s_a1 < 0) ? -1 : 0;
+        loadState(currentProc->p_s);
+    }
+    currentProc->p_s->s_v0 = 0;
+    lockCurrent();
+    pcb_PTR proc = stopCurrent();
+    promoteProc(proc);
+    addSleeper(proc, oldState->s_a1);
+    armClock(); /* in case it is due before whatever the timer was set for */
+    spinUnlock(&semLock);
+    scheduler();
 }
 
 
 void getSupport(state_PTR oldState){
-    stateCopy(oldState, &(currentProc->p_s));
-    currentProc->p_s.s_v0 =(int) currentProc->p_supportStruct;
-    loadState(&currentProc->p_s);   
+    stateCopy(oldState, currentProc->p_s);
+    currentProc->p_s->s_v0 =(int) currentProc->p_supportStruct;
+    loadState(currentProc->p_s);   
+}
+
+/* Set the running process's weight to a1, 1 to MAXWEIGHT. Only stride
+ * scheduling looks at it. v0 is 0, or -1 if a1 is out of range. */
+void setWeight(state_PTR oldState){
+    int weight = oldState->s_a1;
+    stateCopy(oldState, currentProc->p_s);
+    if(weight < 1 || weight > MAXWEIGHT){
+        currentProc->p_s->s_v0 = -1;
+    } else {
+        currentProc->p_acct->a_weight = weight;
+        currentProc->p_s->s_v0 = 0;
+    }
+    loadState(currentProc->p_s);
+}
+
+/* Make the running process real-time: a2 us of cpu every a1 us, earliest
+ * deadline first. a1 of 0 makes it best effort again. v0 is 0, or -1 if
+ * the period and budget make no sense or admission control refused them. */
+void declareRealtime(state_PTR oldState){
+    stateCopy(oldState, currentProc->p_s);
+    if(setRealtime(currentProc, oldState->s_a1, oldState->s_a2)){
+        currentProc->p_s->s_v0 = 0;
+    } else {
+        currentProc->p_s->s_v0 = -1;
+    }
+    loadState(currentProc->p_s);
+}
+
+/* v0 is the caller's cpu time in bucket a1 (ACCTUSER, ACCTSYS, ACCTINT
+ * or ACCTALL), up to now. */
+void getCPUStats(state_PTR oldState){
+    stateCopy(oldState, currentProc->p_s);
+    chargeCurrent(ACCTSYS);
+    currentProc->p_s->s_v0 = cpuTime(currentProc, oldState->s_a1);
+    loadState(currentProc->p_s);
+}
+
+/* Set the running process's time slice to a1 us, MINQUANTUM to
+ * MAXQUANTUM, from its next dispatch on. v0 is the old slice, or -1 if a1
+ * is out of range. */
+void setQuantum(state_PTR oldState){
+    int quantum = oldState->s_a1;
+    stateCopy(oldState, currentProc->p_s);
+    if(quantum < MINQUANTUM || quantum > MAXQUANTUM){
+        currentProc->p_s->s_v0 = -1;
+    } else {
+        currentProc->p_s->s_v0 = currentProc->p_acct->a_quantum;
+        currentProc->p_acct->a_quantum = quantum;
+    }
+    loadState(currentProc->p_s);
+}
+
+/* Write the syscall counters and histograms out now. v0 is 0, or -1 if
+ * the nucleus was built without SYSSTATS or a process had the device, in
+ * which case the dump stops short. semLock keeps every WAITIO and V off
+ * the device meanwhile. */
+void dumpStats(state_PTR oldState){
+    stateCopy(oldState, currentProc->p_s);
+#if SYSSTATS
+    spinLock(&semLock);
+    currentProc->p_s->s_v0 = STATSDUMP() ? 0 : -1;
+    spinUnlock(&semLock);
+#else
+    currentProc->p_s->s_v0 = -1;
+#endif
+    loadState(currentProc->p_s);
+}
+
+/* v0 is statistic a3 of the latencies after interrupts of device a2 on
+ * line a1, see intLatency() in interrupts.c, or -1 if there is none. */
+void getIntLatency(state_PTR oldState){
+    stateCopy(oldState, currentProc->p_s);
+    currentProc->p_s->s_v0 = intLatency(oldState->s_a1, oldState->s_a2, oldState->s_a3);
+    loadState(currentProc->p_s);
+}
+
+/* v0 is the number of deadlines missed by the caller (a1 == RTSTATSELF)
+ * or by every real-time process since boot (a1 == RTSTATALL). */
+void getRtStats(state_PTR oldState){
+    stateCopy(oldState, currentProc->p_s);
+    if(oldState->s_a1 == RTSTATALL){
+        currentProc->p_s->s_v0 = realtimeMisses();
+    } else {
+        currentProc->p_s->s_v0 = currentProc->p_acct->a_rtMisses;
+    }
+    loadState(currentProc->p_s);
 }
 
 /* passes up process */
 void passUpOrDie(state_PTR oldState, int exception){
 	support_t *supportStruct = currentProc->p_supportStruct;
     if((supportStruct == NULL) || supportStruct == 0) {
-        terminateProc(currentProc); 
-        scheduler();
+        terminateCurrent(); 
     }else{
        stateCopy(oldState, &(currentProc->p_supportStruct->sup_exceptState[exception])); 
         unsigned int stackPtrToLoad = currentProc->p_supportStruct->sup_exceptContext[exception].c_stackPtr;
        unsigned int statusToLoad = currentProc->p_supportStruct->sup_exceptContext[exception].c_status;
        unsigned int pcToLoad = currentProc->p_supportStruct->sup_exceptContext[exception].c_pc;
-        /* load context */
+        /* load context: the support level runs as the process, so on its time */
+        chargeCurrent(ACCTUSER);
+        ENDSYSCALL();
+        TRACESYSEXIT(0);
         LDCXT(stackPtrToLoad, statusToLoad, pcToLoad);
     }
 }
@@ -237,11 +474,11 @@ void stateCopy(state_PTR oldState, state_PTR newState){
 
 
 void tlbTrapHandler(){
-	passUpOrDie((state_PTR) BIOSDATAPAGE,  PGFAULTEXCEPT);
+	passUpOrDie(EXCSTATE,  PGFAULTEXCEPT);
 }
 
 void programTrapHandler(){
-	passUpOrDie((state_PTR) BIOSDATAPAGE,  GENERALEXCEPT);
+	passUpOrDie(EXCSTATE,  GENERALEXCEPT);
 }
 
 
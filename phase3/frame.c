@@ -0,0 +1,38 @@
+/************ FRAME.C ************/
+/*
+ * The nucleus page frame allocator.
+ *
+ * The pcb and semaphore descriptor pools start out as small static arrays
+ * and grow a whole frame at a time. Frames are carved upwards from the
+ * first frame past the swap pool, which sits right above the kernel
+ * image, and stop short of the PROCSTACKFRAMES frames at the top of RAM
+ * that hold process stacks. Pool frames are never given back: freed pcbs
+ * and semds go back on their own free lists instead.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/frame.h"
+
+HIDDEN memaddr frameNext; /* next frame to hand out */
+HIDDEN memaddr frameLimit; /* first frame that may not be handed out */
+
+
+void initFrames(){
+    devregarea_t* deviceBus = (devregarea_t*) RAMBASEADDR;
+    memaddr topOfRAM = deviceBus->rambase + deviceBus->ramsize;
+
+    frameNext = SWPSTARTADDR + (POOLSIZE * PAGESIZE);
+    frameLimit = topOfRAM - (PROCSTACKFRAMES * PAGESIZE);
+}
+
+
+/* Return the address of a fresh frame, or NULL once RAM is exhausted. */
+memaddr allocFrame(){
+    if(frameNext >= frameLimit){
+        return (memaddr) NULL;
+    }
+    memaddr frame = frameNext;
+    frameNext += PAGESIZE;
+    return frame;
+}
@@ -13,6 +13,12 @@
 #include "../h/const.h"
 #include "../h/pcb.h"
 #include "../h/asl.h"
+#include "../h/frame.h"
+#include "../h/spinlock.h"
+#include "../h/account.h"
+#include "../h/trace.h"
+#include "../h/timer.h"
+#include "../h/initial.h"
 #include "../h/scheduler.h"
 #include "../h/exceptions.h"
 #include "../h/interrupts.h"
@@ -21,44 +27,95 @@
 /* Define Global Variables */
 int processCount; /* count the number of processes within the readyQueue */
 int softBlockCount; /* count of processes waiting for IO */
-pcb_PTR readyQueue; /* A tail pointer to a queue of pcbs that are in the “ready” state. */ 
-pcb_PTR currentProc; /* Pointer to the pcb that is in the “running” state, i.e. the current executing process. */
 int semDevices[DEVNUM]; /* There are 49 device semaphores, defined in const.h */
-cpu_t startTOD; /* Hold the start of the Time Of Day Clock */
 int *clockSem = &semDevices[DEVNUM-ONE]; /* Clock semaphores within the device semaphores list (49 - 1) = 48 */
+int ncpus; /* processors started, at most MAXCPUS */
+percpu_t cpus[MAXCPUS]; /* each processor's running process (currentProc) and its a_time at dispatch (startTime) */
+spinlock_t pcbLock = UNLOCKED; /* guards the pcb pool, the process tree and processCount */
+spinlock_t semLock = UNLOCKED; /* guards the ASL, semaphore values, device semaphores and softBlockCount */
 
 /* Declaration of internal exceptionHandler and external test() and TLB Refill functions */
 HIDDEN void exceptionHandler();
 extern void test();
 extern void uTLBRefillHandler();
+extern char _end[]; /* end of the kernel image's bss, from the linker script */
 
 
-/* main() serves as the beginning of PandOS where the global variables get intitialized to be used throughout
- * the Operatring System and memory addresses are created.  The scheduler then takes over once main has finished 
- */
-int main(){
-    devregarea_t* deviceBus = (devregarea_t*) RAMBASEADDR;
-    int topOfRAM = (deviceBus->rambase + deviceBus->ramsize); 
-    /* * * * Initialize the pass up vector. * * * */
+/* Fill in processor id's pass up vector so its exceptions and TLB refills
+ * run on its own nucleus stack. */
+HIDDEN void initPassUp(int id){
     /* The pass up vector is where the BIOS finds the address of the Nucleus functions to pass control to. */
-    passupvector_t* nucleusFunctionAddressThatWillReceiveControl = (passupvector_t *) PASSUPVECTOR; 
+    passupvector_t* nucleusFunctionAddressThatWillReceiveControl = CPUPASSUP(id); 
     /* Set the Nucleus TLB-Refill event handler address */
     nucleusFunctionAddressThatWillReceiveControl->tlb_refll_handler = (memaddr) uTLBRefillHandler;
     /* Set the Stack Pointer for the Nucleus TLB-Refill event handler to the top of the stack page */
-    nucleusFunctionAddressThatWillReceiveControl->tlb_refll_stackPtr = NUCLEUSSTACKPAGE; 
+    nucleusFunctionAddressThatWillReceiveControl->tlb_refll_stackPtr = cpus[id].c_stackTop; 
     /* Set the Nucleus exception handler address to the address of the ntry point for Exception Handling */
     nucleusFunctionAddressThatWillReceiveControl->exception_handler = (memaddr) exceptionHandler;
     /* Set the Stack Pointer for the Nucleus exception handler to the top od the Nucleus Stack page */
-    nucleusFunctionAddressThatWillReceiveControl->exception_stackPtr = NUCLEUSSTACKPAGE;
+    nucleusFunctionAddressThatWillReceiveControl->exception_stackPtr = cpus[id].c_stackTop;
+}
+
+/* Start every processor but 0 straight in the scheduler, on its own
+ * nucleus stack page with interrupts off. Device and interval timer
+ * interrupts keep their reset routing to processor 0; the others only
+ * ever see their own local timer. */
+HIDDEN void startCPUs(){
+    state_t startState;
+    int id;
+    for(id = 1; id < ncpus; id++){
+        STST(&startState);
+        startState.s_pc = startState.s_t9 = (memaddr) scheduler;
+        startState.s_sp = cpus[id].c_stackTop;
+        startState.s_status = ALLOFF | TEBITON;
+        INITCPU(id, &startState);
+    }
+}
+
+/* main() serves as the beginning of PandOS where the global variables get intitialized to be used throughout
+ * the Operatring System and memory addresses are created.  The scheduler then takes over once main has finished 
+ */
+int main(){
+    devregarea_t* deviceBus = (devregarea_t*) RAMBASEADDR;
+    int topOfRAM = (deviceBus->rambase + deviceBus->ramsize); 
     
-    /* Initialize the PCBs and ASL */
+    /* The kernel image has to end below the swap pool and the frames past it, see SWPSTARTADDR */
+    if((memaddr) _end > SWPSTARTADDR){
+        PANIC();
+    }
+
+    /* Initialize the frame allocator the PCB and ASL pools grow from, then the PCBs and ASL */
+    initFrames();
     initPcbs();
     initASL();
     
-    /* Ensure the current process is NULL as no process has been called yet */
-    currentProc = NULL;
-    /* make a new empty process queue with tail pointer called readyQueue. The initial pcb will be placed in this queue. */
-    readyQueue = mkEmptyProcQ(); 
+    /* * * * Initialize every processor: no current process yet, a nucleus
+     * stack (processor 0 keeps the usual page, the others get a frame
+     * each) and a pass up vector. * * * */
+    ncpus = MIN(*((unsigned int *) NCPUSADDR), MAXCPUS);
+    int id;
+    for(id = 0; id < ncpus; id++){
+        cpus[id].c_currentProc = NULL;
+        cpus[id].c_steals = cpus[id].c_migrations = 0;
+        cpus[id].c_idle = FALSE;
+        cpus[id].c_idleTime = 0;
+        cpus[id].c_idlePoll = QUANTUM;
+        cpus[id].c_intEntries = cpus[id].c_intServiced = cpus[id].c_intBatchMax = 0;
+        cpus[id].c_intSince = cpus[id].c_maskedMax = 0;
+        cpus[id].c_stackTop = NUCLEUSSTACKPAGE;
+        if(id > 0){
+            memaddr stackPage = allocFrame();
+            if(stackPage == (memaddr) NULL){
+                ncpus = id; /* no room for another stack, run on the ones we have */
+                break;
+            }
+            cpus[id].c_stackTop = stackPage + PAGESIZE;
+        }
+        initPassUp(id);
+    }
+    TRACEINIT(); /* needs ncpus */
+    /* make the ready queue (scheduler.c) empty. The initial pcb will be placed in it. */
+    initReady();
    
     /* Initialize a Process Count and Soft Block Count of 0 */
     processCount = 0;
@@ -69,22 +126,24 @@ int main(){
     for(i=0; i<DEVNUM; i++){
       semDevices[i] = ZERO;
      }
+    initDevices(); /* interrupt decode tables, see interrupts.c */
+    initTimers(); /* the timer wheel SLEEP parks processes on, see timer.c */
      
      /* * * * Dispatch a pcb * * * */
     pcb_PTR firstProc = allocPcb();
     if(firstProc == NULL){ /* if the pcbFree list is empty (aka allocPcb() returns null) */
         PANIC();
     }else{ /* if a pcb was successfully allocated from the pcbFree list */
-        firstProc->p_s.s_pc = (memaddr) test; /* the pc is set to test for help w/ testing */
-        firstProc->p_s.s_t9 = (memaddr) test;
-        firstProc->p_s.s_status = (ALLOFF | IEON | IMON | TEBITON);
-        firstProc->p_s.s_sp = topOfRAM;
+        firstProc->p_s->s_pc = (memaddr) test; /* the pc is set to test for help w/ testing */
+        firstProc->p_s->s_t9 = (memaddr) test;
+        firstProc->p_s->s_status = (ALLOFF | IEON | IMON | TEBITON);
+        firstProc->p_s->s_sp = topOfRAM;
         firstProc->p_supportStruct = NULL;
-        insertProcQ(&readyQueue, firstProc); /* onto the readyQueue, insert firstProc */
+        readyProc(firstProc); /* onto the readyQueue, insert firstProc */
         processCount++; /* Increment process count # */
-        LDIT(IOCLOCK); /* load the system-wide interval timer w/ 100 ms */
+        initClock(); /* start the pseudo-clock, see interrupts.c */
          firstProc = NULL; 
-        STCK(startTOD); 
+        startCPUs();
         scheduler(); /* Pass off the reins to the Scheduler */
     }
     return 0;
@@ -98,10 +157,19 @@ int main(){
 
 void exceptionHandler(){
     state_PTR oldstate;
-    oldstate = (state_PTR) BIOSDATAPAGE;
+    oldstate = EXCSTATE;
     
     /* initiailze the variable holding the Exception cause from the BIOSDATAPAGE */
     int reason = ((oldstate->s_cause & EXCODEMASK) >> SHIFT);
+    /* the process stops running its own code here */
+    chargeCurrent((reason == IOINTERRUPT) ? ACCTINT : ACCTSYS);
+
+    /* Another processor may have terminated the process running here;
+     * it is only freed now that it has stopped running. */
+    if(currentProc != NULL && currentProc->p_acct->a_killed){
+        terminateCurrent();
+    }
+
     if(reason == IOINTERRUPT){ /* IOInterrupt = 0 , const.h */
      IOHandler();
      }
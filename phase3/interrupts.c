@@ -5,125 +5,406 @@
 #include "../h/asl.h"
 #include "../h/scheduler.h"
 #include "../h/exceptions.h"
+#include "../h/initial.h"
+#include "../h/spinlock.h"
+#include "../h/trace.h"
+#include "../h/timer.h"
 #include "/usr/include/umps3/umps/libumps.h"
 
 extern int semDevices[DEVNUM];
-extern pcb_PTR readyQueue;
-extern pcb_PTR currentProc;
 extern int softBlockCount;
 extern int * clockSem;
-extern cpu_t startTOD;
 extern void stateCopy(state_PTR oldState, state_PTR newState);
 
-cpu_t stopTOD;
 void prepToSwitch();
 
-void IOHandler(){
-    state_PTR  oldState = (state_PTR) BIOSDATAPAGE;
+/* Interrupts taken on each line since boot. interruptCount[line] divided by
+ * the TOD in seconds is that line's interrupts per second. */
+unsigned int interruptCount[INTLINES];
 
-    int ip_bits = ((oldState->s_cause & IPMASK) >> 8);
-    int intlNo = 0;
-    if(ip_bits & LINE0INTON){
+HIDDEN cpu_t nextTick; /* TOD of the next pseudo-clock tick, ticks fall every IOCLOCK from boot */
+
+HIDDEN unsigned char lowBit[256]; /* lowBit[b] is the number of the lowest bit set in b */
+HIDDEN devdesc_t devices[DEVINTNUM][DEVPERINT]; /* devices[line - DISKINT][devNo] */
+HIDDEN spinlock_t latLock = UNLOCKED; /* every d_runLat, see endWakeup() */
+
+#if DEFERRED
+/* Work the top halves left for runDeferred(). Only processor 0 takes
+ * device and pseudo-clock interrupts, so it alone advances the Posted
+ * counters and each ring's d_head; the bottom halves, on any processor,
+ * advance the Done counters and d_tail under semLock. */
+HIDDEN volatile unsigned int clockPosted, clockDone; /* interval timer interrupts */
+HIDDEN volatile unsigned int devPosted, devDone; /* device completions, all rings */
+#endif
 
-       PANIC();
-    } else if (ip_bits & LINE1INTON) {
 
-        prepToSwitch();
-    } else if (ip_bits & LINE2INTON) {
+/* Build the tables IOHandler() decodes interrupts with, so that finding
+ * the next pending line or device and its registers and semaphore takes
+ * a couple of loads instead of a ladder of tests. */
+void initDevices(){
+    devregarea_t * ram = (devregarea_t *) RAMBASEADDR;
+    int b, line, devNo;
+    lowBit[0] = 8; /* never looked up */
+    for(b = 1; b < 256; b++){
+        lowBit[b] = (b & 1) ? 0 : lowBit[b >> 1] + 1;
+    }
+    for(line = DISKINT; line <= TERMINT; line++){
+        for(devNo = 0; devNo < DEVPERINT; devNo++){
+            devdesc_t *d = &devices[line - DISKINT][devNo];
+            d->d_reg = &ram->devreg[((line - DISKINT) * DEVPERINT) + devNo];
+            d->d_sem = &semDevices[((line - DISKINT) * DEVPERINT) + devNo];
+            d->d_recvSem = (line == TERMINT) ? d->d_sem + DEVPERINT : NULL;
+            d->d_class = line;
+            d->d_devNo = devNo;
+        }
+    }
+}
 
-        LDIT(IOCLOCK);
- 
-        STCK(stopTOD);
 
+/* Start the pseudo-clock. In TICKLESS mode the interval timer is left
+ * stopped until a process waits for a tick. */
+void initClock(){
+    STCK(nextTick);
+    nextTick += IOCLOCK;
+#if TICKLESS
+    STOPIT();
+#else
+    LDIT(IOCLOCK); /* load the system-wide interval timer w/ 100 ms */
+#endif
+}
+
+/* Program the interval timer for the nearest deadline: the next
+ * pseudo-clock tick, always without TICKLESS and only if a process waits
+ * on clockSem with it, or the next turn of the timer wheel if anyone
+ * sleeps. Stop it if there is neither. Called with semLock held. */
+void armClock(){
+    cpu_t now, when, wheelDue;
+    int sleeping = nextTimer(&wheelDue);
+    int ticking = TRUE;
+    STCK(now);
+#if TICKLESS
+    ticking = (headBlocked(clockSem) != NULL);
+    while(ticking && !TODBEFORE(now, nextTick)){
+        nextTick += IOCLOCK;
+    }
+#endif
+    if(!ticking && !sleeping){
+        STOPIT();
+        return;
+    }
+    when = ticking ? nextTick : wheelDue;
+    if(sleeping && TODBEFORE(wheelDue, when)){
+        when = wheelDue;
+    }
+    LDIT(TODBEFORE(now, when) ? when - now : 1);
+}
+
+/* The interval timer went off: wake every process waiting for the
+ * pseudo-clock if a tick is due, and every sleeper due by now, then arm
+ * it for whatever comes next. Called with semLock held. */
+HIDDEN void wakeClock(){
+    cpu_t now;
+    STCK(now);
+    if(!TODBEFORE(now, nextTick)){
         pcb_PTR proc = removeBlocked(clockSem);
         while (proc!=NULL)
         {
-            proc->p_time += (stopTOD- startTOD);
-            insertProcQ(&readyQueue, proc);
+            readyProc(proc);
             proc = removeBlocked(clockSem);
 
             softBlockCount--;
         }
         *clockSem = 0;
-        prepToSwitch();
-    } 
-    if (ip_bits & LINE3INTON) { 
-        intlNo = 3;
-    } else if (ip_bits & LINE4INTON) {
-        intlNo = 4;
-    } else if (ip_bits & LINE5INTON) {
-        intlNo = 5;
-    } else if (ip_bits & LINE6INTON) {
-        intlNo = 6;
-    } else if (ip_bits & LINE7INTON) {
-        intlNo = 7;
+        while(!TODBEFORE(now, nextTick)){
+            nextTick += IOCLOCK;
+        }
     }
-    devregarea_t * ram = (devregarea_t *) RAMBASEADDR;
-    int dev_bits = ram->interrupt_dev[intlNo-3];
-    int devNo;
-    if(dev_bits & LINE0INTON){
-        devNo = 0;
-    } else if (dev_bits & LINE1INTON) {
-        devNo = 1;
-    } else if (dev_bits & LINE2INTON) {
-        devNo = 2;
-    } else if (dev_bits & LINE3INTON) {
-        devNo = 3;
-    } else if (dev_bits & LINE4INTON) {
-        devNo = 4;
-    } else if (dev_bits & LINE5INTON) {
-        devNo = 5;
-    } else if (dev_bits & LINE6INTON) {
-        devNo = 6;
-    } else if (dev_bits & LINE7INTON) {
-        devNo = 7;
-    }
-
-    if( intlNo >= 3){
-        int devi = (intlNo - 3) * DEVPERINT + devNo;
-        int devAddrbase = 0x10000054 + ((intlNo -3) * 0x80) + (devNo * 0x10);
-        int statusCp;
-        device_t * dev = (device_t *) devAddrbase;
-        if (intlNo == 7){
-            if(dev->t_transm_command & TRANSBITS){
-                statusCp = dev->t_transm_status;
-                dev->t_transm_command = ACK;
-            } else {
-                statusCp = dev->t_recv_status;
-                dev->t_recv_command = ACK;
-                devi+=DEVPERINT;
-            }
+    expireTimers(now);
+    armClock();
+}
+
+/* Add a sample of took us to l. */
+HIDDEN void addLatency(latency_t *l, cpu_t took){
+    cpu_t t = took;
+    int bucket = 0;
+    while(t > 1 && bucket < STATBUCKETS - 1){
+        t >>= 1;
+        bucket++;
+    }
+    if(l->l_count == 0 || took < l->l_min){
+        l->l_min = took;
+    }
+    if(took > l->l_max){
+        l->l_max = took;
+    }
+    l->l_sum += took;
+    l->l_count++;
+    l->l_hist[bucket]++;
+}
+
+/* V a semaphore of device d, handing status to the process waiting in
+ * SYS5 if there is one and noting when the interrupt was taken, so its
+ * first dispatch can be timed. Called with semLock held. */
+HIDDEN void wakeDevice(devdesc_t *d, int *semad, unsigned int status, cpu_t taken){
+    (*semad)++;
+    if(*semad>=ZERO){
+        pcb_PTR proc = removeBlocked(semad);
+        if(proc!=NULL){
+            proc->p_s->s_v0 = status;
+            proc->p_acct->a_wakeTOD = taken;
+            proc->p_acct->a_wakeDev = d;
+
+            softBlockCount--;
+            readyProc(proc);
+        }
+    }
+}
+
+/* Top half of an interval timer interrupt: silence the timer, then wake
+ * whoever it went off for or leave that to runDeferred(). wakeClock()
+ * arms it again. */
+HIDDEN void serviceClock(){
+    interruptCount[2]++;
+    TRACEEVENT(TRINTERRUPT, 2, 0);
+    STOPIT();
+#if DEFERRED
+    clockPosted++;
+#else
+    wakeClock();
+#endif
+}
+
+/* Top half for device d, whose interrupt was taken at TOD taken:
+ * acknowledge it, then V its semaphore or leave that to runDeferred(). */
+HIDDEN void serviceDevice(devdesc_t *d, cpu_t taken){
+    unsigned int statusCp;
+    int recv = FALSE;
+    cpu_t acked;
+    interruptCount[d->d_class]++;
+    TRACEEVENT(TRINTERRUPT, d->d_class, d->d_devNo);
+    if (d->d_recvSem != NULL){
+        if(d->d_reg->t_transm_command & TRANSBITS){
+            statusCp = d->d_reg->t_transm_status;
+            d->d_reg->t_transm_command = ACK;
         } else {
-            statusCp = dev->d_status;
-            dev->d_command = ACK;
+            statusCp = d->d_reg->t_recv_status;
+            d->d_reg->t_recv_command = ACK;
+            recv = TRUE;
         }
-        int *semad = &semDevices[devi];
-        (*semad)++;
-        if(*semad>=ZERO){
-            pcb_PTR proc = removeBlocked(semad);
-            if(proc!=NULL){
-                STCK(stopTOD);
-                proc->p_time += (stopTOD- startTOD);
- 
-                proc->p_s.s_v0 = statusCp;
-
-                softBlockCount--;
-                insertProcQ(&readyQueue, proc);
+    } else {
+        statusCp = d->d_reg->d_status;
+        d->d_reg->d_command = ACK;
+    }
+    STCK(acked);
+    addLatency(&d->d_ackLat, acked - taken); /* only processor 0 gets here */
+#if DEFERRED
+    if(d->d_head - d->d_tail == DEVRING){
+        PANIC(); /* more completions than commands a device can have in flight */
+    }
+    d->d_ring[d->d_head % DEVRING] = recv ? (statusCp | DEVRINGRECV) : statusCp;
+    d->d_ringTOD[d->d_head % DEVRING] = taken;
+    d->d_head++;
+    devPosted++;
+#else
+    wakeDevice(d, recv ? d->d_recvSem : d->d_sem, statusCp, taken);
+#endif
+}
+
+#if DEFERRED
+/* Do one piece of deferred work: an interval timer interrupt or one
+ * device completion. Returns FALSE if there was none. Called with semLock held. */
+HIDDEN int deferredOne(){
+    int i;
+    if(clockDone != clockPosted){
+        clockDone = clockPosted;
+        wakeClock();
+        return TRUE;
+    }
+    for(i = 0; i < DEVINTNUM * DEVPERINT && devDone != devPosted; i++){
+        devdesc_t *d = &devices[0][0] + i;
+        if(d->d_tail != d->d_head){
+            unsigned int status = d->d_ring[d->d_tail % DEVRING];
+            cpu_t taken = d->d_ringTOD[d->d_tail % DEVRING];
+            d->d_tail++;
+            devDone++;
+            if(status & DEVRINGRECV){
+                wakeDevice(d, d->d_recvSem, status & ~DEVRINGRECV, taken);
+            } else {
+                wakeDevice(d, d->d_sem, status, taken);
             }
+            return TRUE;
         }
+    }
+    return FALSE;
+}
+#endif
 
-        prepToSwitch();
+/* Interrupts come back on here: if an interrupt kept them off since it
+ * was taken, record how long that lasted. */
+void endMasked(){
+    percpu_t *cpu = &cpus[getPRID()];
+    cpu_t now;
+    if(cpu->c_intSince != 0){
+        STCK(now);
+        if(now - cpu->c_intSince > cpu->c_maskedMax){
+            cpu->c_maskedMax = now - cpu->c_intSince;
+        }
+        cpu->c_intSince = 0;
     }
+}
+
+/* Bottom half: wake the processes that the interrupts taken since the
+ * last pass completed for. scheduler() calls it before picking a process.
+ * Each wakeup runs under semLock with interrupts off, and device
+ * interrupts are let in between two of them, so how long they stay
+ * masked no longer grows with the wakeups pending. An interrupt taken
+ * there starts scheduler(), and this pass, over from the top. */
+void runDeferred(){
+#if DEFERRED
+    int more = TRUE;
+    while(more){
+        if(clockDone == clockPosted && devDone == devPosted){
+            return; /* unlocked peek, the usual case */
+        }
+        spinLock(&semLock);
+        more = deferredOne();
+        spinUnlock(&semLock);
+        endMasked();
+        setSTATUS(ALLOFF | IECON | IMON);
+        setSTATUS(ALLOFF);
+    }
+#endif
+}
+
+/* p, woken by a device interrupt, is being dispatched for the first time
+ * since: time how long that took. */
+void endWakeup(pcb_PTR p){
+    cpu_t now;
+    STCK(now);
+    spinLock(&latLock);
+    addLatency(&p->p_acct->a_wakeDev->d_runLat, now - p->p_acct->a_wakeTOD);
+    spinUnlock(&latLock);
+    p->p_acct->a_wakeTOD = 0;
+}
+
+/* Statistic what (see GETINTLATENCY in const.h) of the latencies after
+ * interrupts of device devNo on line, or -1 if there is no such device
+ * or statistic. */
+int intLatency(int line, int devNo, int what){
+    latency_t *l;
+    unsigned int rank, seen = 0;
+    int bucket, ret = -1;
+    if(line < DISKINT || line > TERMINT || devNo < 0 || devNo >= DEVPERINT){
+        return -1;
+    }
+    l = (what & LATACK) ? &devices[line - DISKINT][devNo].d_ackLat : &devices[line - DISKINT][devNo].d_runLat;
+    spinLock(&latLock);
+    switch(what & ~LATACK){
+    case LATCOUNT:
+        ret = l->l_count;
+        break;
+    case LATMIN:
+        ret = l->l_min;
+        break;
+    case LATAVG:
+        ret = (l->l_count == 0) ? 0 : l->l_sum / l->l_count;
+        break;
+    case LATMAX:
+        ret = l->l_max;
+        break;
+    case LATP99:
+        ret = 0;
+        rank = l->l_count - (l->l_count / 100); /* samples at or below the 99th percentile */
+        for(bucket = 0; bucket < STATBUCKETS && seen < rank; bucket++){
+            seen += l->l_hist[bucket];
+            ret = MIN((1 << (bucket + 1)) - 1, (int) l->l_max);
+        }
+        break;
+    }
+    spinUnlock(&latLock);
+    return ret;
+}
 
+/* Service every pending interrupt before making one scheduling decision.
+ * Lines are drained in priority order, line 1 (this processor's timer)
+ * first and then the pseudo-clock and devices, lowest line and device
+ * number first, and Cause.IP is read again after each pass so anything
+ * that came up meanwhile is taken in the same entry. At most IOPASSES
+ * passes are made, so a device that keeps interrupting cannot hold the
+ * processor here for good. */
+void IOHandler(){
+    state_PTR  oldState = EXCSTATE;
+    percpu_t *cpu = &cpus[getPRID()];
+    devregarea_t * ram = (devregarea_t *) RAMBASEADDR;
+    unsigned int ip_bits = ((oldState->s_cause & IPMASK) >> 8);
+    unsigned int dev_bits;
+    unsigned int serviced = 0;
+    int intlNo, pass;
+    cpu_t taken;
+
+    STCK(taken);
+    if(cpu->c_intSince == 0){
+        cpu->c_intSince = taken;
+    }
+
+    if(ip_bits & LINE0INTON){
+
+       PANIC();
+    }
+    if (ip_bits & LINE1INTON) {
+        interruptCount[1]++;
+        TRACEEVENT(TRINTERRUPT, 1, 0);
+        serviced++;
+        /* the processor local timer ran out: currentProc used its whole quantum */
+        if(currentProc != NULL){
+            demoteProc(currentProc);
+        }
+    }
+
+#if !DEFERRED
+    spinLock(&semLock);
+#endif
+    ip_bits &= ~(LINE0INTON | LINE1INTON); /* the timer stays pending until the next dispatch */
+    for(pass = 0; pass < IOPASSES && ip_bits != 0; pass++){
+        while(ip_bits != 0){
+            intlNo = lowBit[ip_bits];
+            ip_bits &= ip_bits - 1;
+            if(intlNo == 2){ /* the pseudo-clock */
+                serviceClock();
+                serviced++;
+                continue;
+            }
+            /* without DEFERRED this is read under semLock: another processor may have just taken some */
+            dev_bits = ram->interrupt_dev[intlNo - DISKINT];
+            while(dev_bits != 0){
+                serviceDevice(&devices[intlNo - DISKINT][lowBit[dev_bits]], taken);
+                dev_bits &= dev_bits - 1;
+                serviced++;
+            }
+        }
+        ip_bits = ((getCAUSE() & IPMASK) >> 8) & ~(LINE0INTON | LINE1INTON);
+    }
+#if !DEFERRED
+    spinUnlock(&semLock);
+#endif
+
+    cpu->c_intEntries++;
+    cpu->c_intServiced += serviced;
+    if(serviced > cpu->c_intBatchMax){
+        cpu->c_intBatchMax = serviced;
+    }
+    prepToSwitch();
 }
 
 
 void prepToSwitch(){
-    state_PTR oldState = (state_PTR) BIOSDATAPAGE;
+    state_PTR oldState = EXCSTATE;
 
     if(currentProc!=NULL){
-        stateCopy(oldState, &(currentProc->p_s));
-        insertProcQ(&readyQueue, currentProc);
+        lockCurrent();
+        stateCopy(oldState, currentProc->p_s);
+        readyProc(stopCurrent());
+        spinUnlock(&semLock);
     }
 
     scheduler();
@@ -3,16 +3,31 @@
 #include "../h/const.h"
 #include "../h/types.h"
 #include "../h/pcb.h"
+#include "../h/frame.h"
 HIDDEN pcb_PTR pcb_free_h;
+HIDDEN pcb_PTR pcbSlab; /* next never used pcb in the newest slab frame */
+HIDDEN pcbacct_t *pcbSlabAcct; /* the cold accounting slot that goes with it */
+HIDDEN state_PTR pcbSlabState; /* and its cold state slot */
+HIDDEN int pcbSlabLeft; /* never used pcbs left in that frame */
+
+/* A slab frame holds PCBSPERSLAB hot pcb records followed by the same
+ * number of cold pcbacct_t slots and then of cold state_t slots; pcb i of
+ * the slab owns accounting slot i and state slot i. */
+#define PCBSPERSLAB	(PAGESIZE / (sizeof(pcb_t) + sizeof(pcbacct_t) + sizeof(state_t)))
 
 
 void initPcbs()
 {
     static pcb_t pcbs[MAXPROC];
+    static pcbacct_t pcbAccts[MAXPROC];
+    static state_t pcbStates[MAXPROC];
     pcb_free_h = NULL;
+    pcbSlabLeft = 0;
     int i = 0;
     for (i = 0; i < MAXPROC; i++)
     {
+        pcbs[i].p_s = &(pcbStates[i]);
+        pcbs[i].p_acct = &(pcbAccts[i]);
         freePcb(&(pcbs[i]));
     }
 }
@@ -35,6 +50,7 @@ void insertProcQ(pcb_PTR *tp, pcb_PTR p)
         p->p_prev->p_next = p;
     }
     (*tp) = p;
+    p->p_queue = tp;
     }
 }
 
@@ -49,6 +65,7 @@ pcb_PTR removeProcQ(pcb_PTR *tp)
     if (tail->p_prev == tail)
     {
         (*tp) = NULL;
+        tail->p_queue = NULL;
         return tail;
     }
     else
@@ -57,35 +74,36 @@ pcb_PTR removeProcQ(pcb_PTR *tp)
         pcb_PTR remove = tail->p_prev;
         remove->p_prev->p_next = remove->p_next;
         remove->p_next->p_prev = remove->p_prev;
+        remove->p_queue = NULL;
         return remove;
     }
 }
 
 
+/*
+* Remove p from the queue whose tail pointer is tp. p records the queue it
+* was inserted on, so membership is a single compare and the unlink does
+* not walk the queue. Return NULL if p is not on that queue.
+*/
 pcb_PTR outProcQ(pcb_PTR *tp, pcb_PTR p)
 {
-    pcb_PTR tail = *tp;
     if(emptyProcQ(p)) return NULL;
-    if(emptyProcQ(tail)) return NULL;
-    pcb_PTR temp = tail->p_next;
-    while(temp != p && temp != tail)
+    if(p->p_queue != tp) return NULL;
+    if(p->p_next == p)
     {
-        temp = temp->p_next;
+        (*tp) = NULL;
     }
-    if(temp == p){
+    else
+    {
         p->p_next->p_prev = p->p_prev;
         p->p_prev->p_next = p->p_next;
-        if(temp == tail && tail->p_next == tail)
+        if((*tp) == p)
         {
-            (*tp) = NULL;
-        }else if(temp == tail)
-        {
-            (*tp) = tail->p_next;
+            (*tp) = p->p_next;
         }
-        return temp;
-    } else {
-        return NULL;
     }
+    p->p_queue = NULL;
+    return p;
 }
 
 void insertChild(pcb_PTR parent, pcb_PTR p)
@@ -101,8 +119,10 @@ void insertChild(pcb_PTR parent, pcb_PTR p)
     {
         p->p_sib = parent->p_child;
         p->p_prnt = parent;
+        parent->p_child->p_sibPrev = p;
         parent->p_child = p;
     }
+    p->p_sibPrev = NULL;
 }
 }
 
@@ -115,9 +135,7 @@ pcb_PTR removeChild(pcb_PTR p)
     }
     else
     {
-        pcb_PTR child = p->p_child;
-        p->p_child = child->p_sib;
-        return child;
+        return outChild(p->p_child);
     }
 }
 
@@ -125,30 +143,27 @@ pcb_PTR removeChild(pcb_PTR p)
 * Make the pcb pointed to by p no longer the child of its parent. If
 * the pcb pointed to by p has no parent, return NULL; otherwise, return
 * p. Note that the element pointed to by p need not be the first child of
-* its parent.
+* its parent. The sibling list is doubly linked, so this does not walk it.
 */
 pcb_PTR outChild(pcb_PTR p)
 {
     if(p->p_prnt == NULL) return NULL;
-    pcb_PTR parent = p->p_prnt;
-    pcb_PTR currentChild = parent->p_child;
-    pcb_PTR lastChild = NULL;
-    if (currentChild == p)
+    if(p->p_sibPrev == NULL)
     {
-        return removeChild(parent);
+        p->p_prnt->p_child = p->p_sib;
     }
-    while (currentChild != NULL)
+    else
     {
-        if (currentChild == p)
-        {
-            lastChild->p_sib = p->p_sib;
-            p->p_prnt = NULL;
-            return p;
-        }
-        lastChild = currentChild;
-        currentChild = currentChild->p_sib;
+        p->p_sibPrev->p_sib = p->p_sib;
     }
-    return NULL;
+    if(p->p_sib != NULL)
+    {
+        p->p_sib->p_sibPrev = p->p_sibPrev;
+    }
+    p->p_prnt = NULL;
+    p->p_sib = NULL;
+    p->p_sibPrev = NULL;
+    return p;
 }
 
 
@@ -182,20 +197,66 @@ pcb_PTR mkEmptyProcQ()
 
 void freePcb(pcb_PTR p)
 {
+    if(!emptyProcQ(p) && p->p_queue == &(pcb_free_h)) return; /* already free */
     insertProcQ(&(pcb_free_h), p);
 }
 
 
+/*
+* Hand out the next never used pcb of the newest slab, carving a fresh
+* slab out of a whole page frame when that one is used up, and bind it to
+* its cold accounting and state slots. Return NULL only when no frame is left.
+*/
+HIDDEN pcb_PTR carvePcb()
+{
+    if (pcbSlabLeft == 0)
+    {
+        memaddr frame = allocFrame();
+        if (frame == (memaddr) NULL)
+        {
+            return NULL;
+        }
+        pcbSlab = (pcb_PTR) frame;
+        pcbSlabAcct = (pcbacct_t *) (pcbSlab + PCBSPERSLAB);
+        pcbSlabState = (state_PTR) (pcbSlabAcct + PCBSPERSLAB);
+        pcbSlabLeft = PCBSPERSLAB;
+    }
+    pcbSlabLeft--;
+    pcbSlab->p_s = pcbSlabState++;
+    pcbSlab->p_acct = pcbSlabAcct++;
+    return pcbSlab++;
+}
+
+
 pcb_PTR allocPcb()
 {
     pcb_PTR allocate = removeProcQ(&(pcb_free_h));
+    if(allocate==NULL){
+        allocate = carvePcb();
+    }
     if(allocate!=NULL){
         allocate->p_child = NULL;
         allocate->p_next = NULL;
+        allocate->p_prev = NULL;
+        allocate->p_queue = NULL;
+        allocate->p_cpu = NOCPU;
+        allocate->p_acct->a_killed = FALSE;
         allocate->p_prnt = NULL;
         allocate->p_semAdd = NULL;
         allocate->p_sib = NULL;
-        allocate->p_time = NULL;
+        allocate->p_sibPrev = NULL;
+        allocate->p_acct->a_time = 0;
+        allocate->p_acct->a_sysTime = 0;
+        allocate->p_acct->a_intTime = 0;
+        allocate->p_level = 0;
+        allocate->p_acct->a_quantum = QUANTUM;
+        allocate->p_acct->a_dispatches = 0;
+        allocate->p_acct->a_wakeTOD = 0;
+        allocate->p_acct->a_sleepTick = 0;
+        allocate->p_acct->a_weight = DEFAULTWEIGHT;
+        allocate->p_pass = 0;
+        allocate->p_acct->a_rtPeriod = 0;
+        allocate->p_acct->a_rtMisses = 0;
         allocate->p_supportStruct = NULL;
     }
     
@@ -0,0 +1,77 @@
+/************ pingTest.c ************/
+/* Nucleus benchmark for semaphore ping-pong wakeup latency.
+ *
+ * Linked in place of initProc.c (make ping) so test() here is the first
+ * process. It starts PINGSPINNERS CPU bound processes so the readyQueue
+ * is never empty, then a pinger and a ponger that bounce PINGROUNDS times
+ * between two semaphores with SYS3/SYS4. The pinger reports the average
+ * round trip on terminal 0. Build the nucleus with HANDOFF=TRUE and
+ * HANDOFF=FALSE to compare. Finally test() terminates, which takes the
+ * spinners with it and HALTs.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/testLib.h"
+#include "../h/libumps.h"
+
+#define PINGROUNDS	1000
+#define PINGSPINNERS	3
+#define PINGSTACK	1024	/* stack bytes given to each process */
+
+HIDDEN int ping = 0;		/* V'd by the pinger, P'd by the ponger */
+HIDDEN int pong = 0;		/* V'd by the ponger, P'd by the pinger */
+HIDDEN int pingDone = 0;	/* V'd by the pinger once it has reported */
+
+/* Keep the readyQueue busy until test() terminates. */
+HIDDEN void spinner()
+{
+	while (TRUE)
+		;
+}
+
+HIDDEN void ponger()
+{
+	while (TRUE) {
+		SYSCALL(PASSEREN, (int) &ping, 0, 0);
+		SYSCALL(VERHOGEN, (int) &pong, 0, 0);
+	}
+}
+
+HIDDEN void pinger()
+{
+	cpu_t start, end;
+	int round;
+
+	STCK(start);
+	for (round = 0; round < PINGROUNDS; round++) {
+		SYSCALL(VERHOGEN, (int) &ping, 0, 0);
+		SYSCALL(PASSEREN, (int) &pong, 0, 0);
+	}
+	STCK(end);
+
+	print("pingTest: ");
+	printNum(PINGROUNDS);
+	print(" round trips, ");
+	printNum((end - start) / PINGROUNDS);
+	print(" us each\n");
+	SYSCALL(VERHOGEN, (int) &pingDone, 0, 0);
+	SYSCALL(PASSEREN, (int) &pong, 0, 0);	/* wait here to be terminated */
+}
+
+void test()
+{
+	int i;
+
+	initSpawn(PINGSTACK);
+
+	print("pingTest: P/V ping-pong next to CPU bound processes\n");
+	for (i = 0; i < PINGSPINNERS; i++)
+		spawn(spinner, i, 0);
+	spawn(ponger, PINGSPINNERS, 0);
+	spawn(pinger, PINGSPINNERS + 1, 0);
+
+	SYSCALL(PASSEREN, (int) &pingDone, 0, 0);
+	print("pingTest: done\n");
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
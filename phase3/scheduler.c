@@ -4,6 +4,36 @@
  * For: PandOS project CSCI 320
  * This is a round-robin scheduling algorithm with a time slice value of 5ms.
  * The Scheduler is called! So dispatch next process from the readyQueue.
+ *
+ * The ready queue is kept here and the rest of the nucleus only goes through
+ * readyProc() and outReady(). Built with SCHEDPOLICY == SCHEDMLFQ it is split
+ * into MLFQLEVELS levels: a process that burns its whole quantum drops a
+ * level, one that blocks for I/O or the clock climbs one, lower levels get
+ * longer quanta, and every MLFQBOOST the whole ready queue is moved back up
+ * to level 0 so nothing starves. Round robin is the same code with one level.
+ * SCHEDPOLICY == SCHEDSTRIDE keeps one level too, but runs the ready
+ * process with the lowest pass instead of the oldest. A process's pass
+ * grows by STRIDE1 / a_weight for every STRIDEUNIT it runs, so over time
+ * each one gets cpu in proportion to the weight it set with SETWEIGHT.
+ * The queue is scanned for the lowest pass rather than kept sorted: it
+ * rarely holds more than a handful of processes.
+ *
+ * Ahead of all of that sits the real-time class. A process that declares a
+ * period and a budget with SETREALTIME goes on rtQueue, shared by every
+ * processor, and the one with the earliest deadline runs first for at most
+ * its quantum of its remaining budget. Budgets work like a constant bandwidth
+ * server: one used up before the deadline moves the deadline a period on
+ * and refills, so an overrunning process only hurts itself, and a process
+ * that wakes after its deadline starts a fresh period. A process still
+ * short of its budget when the deadline passes has missed it. Admission
+ * control keeps the promised budgets under RTMAXLOAD of one processor.
+ *
+ * Every processor runs the scheduler on its own and has its own ready
+ * queue. Processes created, woken or preempted on a processor go on its
+ * queue. A processor whose queue is empty steals half of the busiest
+ * queue, and failing that waits, looking again every QUANTUM. How often
+ * that happens is counted in cpus[] (c_steals, c_migrations, c_idleTime),
+ * which can be watched from the uMPS3 debugger.
  */
 
 #include <stdio.h>
@@ -13,59 +43,555 @@
 #include "../h/asl.h"
 #include "../h/scheduler.h"
 #include "../h/initial.h"
+#include "../h/spinlock.h"
+#include "../h/account.h"
+#include "../h/sysStats.h"
+#include "../h/trace.h"
+#include "../h/interrupts.h"
 #include "../h/libumps.h"
 
-/* Bring in the Start Time Of Day Clock variable */
-extern cpu_t startTOD;
+#if SCHEDPOLICY == SCHEDMLFQ
+#define READYLEVELS MLFQLEVELS
+#else
+#define READYLEVELS 1
+#endif
+
+HIDDEN pcb_PTR readyQueue[MAXCPUS][READYLEVELS]; /* tail pointers of each processor's ready queues, one per level */
+HIDDEN int readyCount[MAXCPUS]; /* processes on each processor's ready queues */
+HIDDEN spinlock_t readyLock[MAXCPUS]; /* guard one processor's readyQueue and readyCount, taken after pcbLock and semLock */
+#if SCHEDPOLICY == SCHEDMLFQ
+HIDDEN cpu_t lastBoost[MAXCPUS]; /* TOD of each processor's last priority boost */
+#endif
+HIDDEN pcb_PTR rtQueue; /* tail pointer of the ready real-time processes of every processor */
+HIDDEN spinlock_t rtLock; /* guards rtQueue, rtLoad and rtMisses, taken after semLock and never with a readyLock */
+HIDDEN unsigned int rtLoad; /* per mille of a processor promised to real-time processes */
+HIDDEN unsigned int rtMisses; /* deadlines missed by every real-time process since boot */
+
+#if SCHEDPOLICY == SCHEDSTRIDE
+HIDDEN unsigned int globalPass[MAXCPUS]; /* pass of the process each processor dispatched last */
+
+/* TRUE if pass a comes before pass b. Passes only ever grow and wrap
+ * around, so they are compared by their difference. */
+#define PASSBEFORE(a, b) ((int) ((a) - (b)) < 0)
+#endif
+
+
+/* Empty the ready queues. Called once by main() before the first process exists. */
+void initReady(){
+    int id, level;
+    for(id = 0; id < MAXCPUS; id++){
+        for(level = 0; level < READYLEVELS; level++){
+            readyQueue[id][level] = mkEmptyProcQ();
+        }
+        readyCount[id] = 0;
+        readyLock[id] = UNLOCKED;
+#if SCHEDPOLICY == SCHEDMLFQ
+        STCK(lastBoost[id]);
+#endif
+#if SCHEDPOLICY == SCHEDSTRIDE
+        globalPass[id] = 0;
+#endif
+    }
+    rtQueue = mkEmptyProcQ();
+    rtLock = UNLOCKED;
+    rtLoad = 0;
+    rtMisses = 0;
+}
+
+/* Per mille of a processor a budget every period takes, rounded up. */
+HIDDEN unsigned int rtShare(cpu_t period, cpu_t budget){
+    return ((budget * 1000) + period - 1) / period;
+}
+
+/* Make p real-time with budget us of cpu every period us, starting a
+ * period now, or best effort again if period is 0. Returns FALSE, leaving
+ * p as it was, if the numbers make no sense or admitting p would promise
+ * more than RTMAXLOAD. */
+int setRealtime(pcb_PTR p, cpu_t period, cpu_t budget){
+    unsigned int load;
+    if(period == 0){
+        leaveRealtime(p);
+        return TRUE;
+    }
+    if(budget == 0 || budget > period || period > RTMAXPERIOD){
+        return FALSE;
+    }
+    load = rtShare(period, budget);
+    spinLock(&rtLock);
+    if(p->p_acct->a_rtPeriod != 0){
+        rtLoad -= rtShare(p->p_acct->a_rtPeriod, p->p_acct->a_rtBudget);
+    }
+    if(rtLoad + load > RTMAXLOAD){
+        if(p->p_acct->a_rtPeriod != 0){
+            rtLoad += rtShare(p->p_acct->a_rtPeriod, p->p_acct->a_rtBudget);
+        }
+        spinUnlock(&rtLock);
+        return FALSE;
+    }
+    rtLoad += load;
+    spinUnlock(&rtLock);
+    p->p_acct->a_rtPeriod = period;
+    p->p_acct->a_rtBudget = budget;
+    p->p_acct->a_rtLeft = budget;
+    STCK(p->p_acct->a_deadline);
+    p->p_acct->a_deadline += period;
+    return TRUE;
+}
+
+/* Give back p's share of the real-time class, if it has one. */
+void leaveRealtime(pcb_PTR p){
+    if(p->p_acct->a_rtPeriod != 0){
+        spinLock(&rtLock);
+        rtLoad -= rtShare(p->p_acct->a_rtPeriod, p->p_acct->a_rtBudget);
+        spinUnlock(&rtLock);
+        p->p_acct->a_rtPeriod = 0;
+    }
+}
+
+/* Deadlines missed by every real-time process since boot. */
+unsigned int realtimeMisses(){
+    return rtMisses;
+}
+
+/* Put the real-time process p on rtQueue, in a fresh period if its
+ * deadline is already behind it. */
+HIDDEN void readyRealtime(pcb_PTR p){
+    cpu_t now;
+    STCK(now);
+    if(!TODBEFORE(now, p->p_acct->a_deadline)){
+        p->p_acct->a_deadline = now + p->p_acct->a_rtPeriod;
+        p->p_acct->a_rtLeft = p->p_acct->a_rtBudget;
+    }
+    spinLock(&rtLock);
+    insertProcQ(&rtQueue, p);
+    spinUnlock(&rtLock);
+}
+
+/* Make p runnable: put it on the tail of this processor's ready queue for its level. */
+void readyProc(pcb_PTR p){
+    int id = getPRID();
+    if(p->p_acct->a_rtPeriod != 0){
+        readyRealtime(p);
+        return;
+    }
+    spinLock(&readyLock[id]);
+#if SCHEDPOLICY == SCHEDSTRIDE
+    /* A process back from blocking (or a new one) starts level with the
+     * others instead of spending the pass it did not use while away. */
+    if(PASSBEFORE(p->p_pass, globalPass[id])){
+        p->p_pass = globalPass[id];
+    }
+#endif
+    insertProcQ(&readyQueue[id][p->p_level], p);
+    readyCount[id]++;
+    spinUnlock(&readyLock[id]);
+}
+
+/* The processor whose ready queues p is on, NOCPU if it is on none. */
+HIDDEN int readyCPU(pcb_PTR p){
+    pcb_PTR *q = p->p_queue;
+    if(q < &readyQueue[0][0] || q >= &readyQueue[MAXCPUS][0]){
+        return NOCPU;
+    }
+    return (q - &readyQueue[0][0]) / READYLEVELS;
+}
+
+/* Take p off the ready queue it is on. Returns p, or NULL if p was not
+ * ready: blocked, or claimed by a processor (p_cpu set) to run. Called
+ * with semLock held, so a blocked p cannot become ready meanwhile. A
+ * ready p is only ever off every queue with p_cpu NOCPU while
+ * stealReady() moves it, holding both ready locks, so before trusting
+ * an empty p_queue this waits out whoever holds each of them. */
+pcb_PTR outReady(pcb_PTR p){
+    int id, i;
+    while(TRUE){
+        if(p->p_queue == &rtQueue){
+            spinLock(&rtLock);
+            if(p->p_queue == &rtQueue){
+                outProcQ(&rtQueue, p);
+                spinUnlock(&rtLock);
+                return p;
+            }
+            spinUnlock(&rtLock);
+            continue; /* taken off meanwhile, look again */
+        }
+        id = readyCPU(p);
+        if(id != NOCPU){
+            spinLock(&readyLock[id]);
+            if(p->p_queue == &readyQueue[id][p->p_level]){
+                outProcQ(&readyQueue[id][p->p_level], p);
+                readyCount[id]--;
+                spinUnlock(&readyLock[id]);
+                return p;
+            }
+            spinUnlock(&readyLock[id]);
+            continue; /* taken or stolen meanwhile, look again */
+        }
+        if(p->p_cpu != NOCPU || p->p_semAdd != NULL || p->p_acct->a_sleepTick != 0){
+            return NULL;
+        }
+        for(i = 0; i < ncpus; i++){
+            spinLock(&readyLock[i]);
+            spinUnlock(&readyLock[i]);
+        }
+        if(p->p_queue == NULL && p->p_cpu == NOCPU){
+            return NULL; /* not moving either: it really is on no queue */
+        }
+    }
+}
+
+/* p used up its whole quantum: it runs at the next level down from now on. */
+void demoteProc(pcb_PTR p){
+    if(p->p_level < READYLEVELS - 1){
+        p->p_level++;
+    }
+}
+
+/* p blocked for I/O or the pseudo-clock: it runs one level up from now on. */
+void promoteProc(pcb_PTR p){
+    if(p->p_level > 0){
+        p->p_level--;
+    }
+}
+
+/* How much of the left us of the running process's slice a V that woke
+ * p may hand it with HANDOFF: 0 unless p is in the same class, so it is
+ * never run outside what its policy grants. Real-time processes are left
+ * to rtQueue and their budgets, under MLFQ both must be on one level, and
+ * under stride p's pass, caught up as readyProc() would, must not be past
+ * the caller's. Never more than p's own slice. Called with semLock held. */
+int handOffSlice(pcb_PTR p, int left){
+    pcb_PTR from = currentProc;
+    if(p->p_acct->a_rtPeriod != 0 || from->p_acct->a_rtPeriod != 0){
+        return 0;
+    }
+#if SCHEDPOLICY == SCHEDMLFQ
+    if(p->p_level != from->p_level){
+        return 0;
+    }
+#elif SCHEDPOLICY == SCHEDSTRIDE
+    if(PASSBEFORE(p->p_pass, globalPass[getPRID()])){
+        p->p_pass = globalPass[getPRID()];
+    }
+    if(PASSBEFORE(from->p_pass, p->p_pass)){
+        return 0;
+    }
+#endif
+    return MIN(left, p->p_acct->a_quantum << p->p_level);
+}
+
+/* Take the running process off this processor, charge it for the time it
+ * ran and return it. Callers hold semLock until the process is on a
+ * ready queue or the ASL, so the deadlock check in scheduler() never sees
+ * it in between. Its real-time budget and stride pass are charged what
+ * a_time grew by since dispatch, so interrupt time is left out of both. */
+pcb_PTR stopCurrent(){
+    cpu_t now;
+    cpu_t ran;
+    pcb_PTR p = currentProc;
+    chargeCurrent(ACCTSYS);
+    STCK(now);
+    ran = p->p_acct->a_time - startTime;
+    ENDSYSCALL();
+    TRACESYSEXIT(0);
+    if(p->p_acct->a_rtPeriod != 0){
+        p->p_acct->a_rtLeft -= ran;
+        if(!TODBEFORE(now, p->p_acct->a_deadline)){
+            /* still wanted the cpu when its deadline passed */
+            p->p_acct->a_rtMisses++;
+            spinLock(&rtLock);
+            rtMisses++;
+            spinUnlock(&rtLock);
+            p->p_acct->a_deadline = now + p->p_acct->a_rtPeriod;
+            p->p_acct->a_rtLeft = p->p_acct->a_rtBudget;
+        } else if(p->p_acct->a_rtLeft <= 0){
+            p->p_acct->a_deadline += p->p_acct->a_rtPeriod;
+            p->p_acct->a_rtLeft = p->p_acct->a_rtBudget;
+        }
+    }
+#if SCHEDPOLICY == SCHEDSTRIDE
+    {
+        unsigned int stride = STRIDE1 / p->p_acct->a_weight;
+        /* split so ran * stride cannot overflow on a long slice */
+        p->p_pass += ((ran / STRIDEUNIT) * stride) + (((ran % STRIDEUNIT) * stride) / STRIDEUNIT);
+    }
+#endif
+    p->p_cpu = NOCPU;
+    currentProc = NULL;
+    return p;
+}
+
+#if SCHEDPOLICY == SCHEDMLFQ
+/* Every MLFQBOOST, move every process on this processor's ready queues back
+ * to level 0 in its current order so CPU bound processes at the bottom
+ * cannot starve. Blocked processes keep their level until they are readied. */
+HIDDEN void boostReady(){
+    cpu_t now;
+    int id = getPRID();
+    int level;
+    STCK(now);
+    spinLock(&readyLock[id]);
+    if((now - lastBoost[id]) >= MLFQBOOST){
+        lastBoost[id] = now;
+        for(level = 1; level < READYLEVELS; level++){
+            pcb_PTR p = removeProcQ(&readyQueue[id][level]);
+            while(p != NULL){
+                p->p_level = 0;
+                insertProcQ(&readyQueue[id][0], p);
+                p = removeProcQ(&readyQueue[id][level]);
+            }
+        }
+    }
+    spinUnlock(&readyLock[id]);
+}
+#endif
+
+/* The real-time process with the earliest deadline on rtQueue, claimed
+ * for this processor, or NULL if there is none. */
+HIDDEN pcb_PTR nextRealtime(){
+    pcb_PTR next, p;
+    if(emptyProcQ(rtQueue)){ /* only a hint, but spares the lock on every dispatch */
+        return NULL;
+    }
+    spinLock(&rtLock);
+    next = headProcQ(rtQueue);
+    if(next != NULL){
+        for(p = next->p_prev; p != headProcQ(rtQueue); p = p->p_prev){ /* oldest to newest */
+            if(TODBEFORE(p->p_acct->a_deadline, next->p_acct->a_deadline)){
+                next = p;
+            }
+        }
+        next->p_cpu = getPRID(); /* claimed before it leaves the queue, see outReady() */
+        outProcQ(&rtQueue, next);
+    }
+    spinUnlock(&rtLock);
+    return next;
+}
+
+#if SCHEDPOLICY == SCHEDSTRIDE
+/* The process with the lowest pass on the queue whose tail is tp, the
+ * oldest of them on a tie. NULL if the queue is empty. */
+HIDDEN pcb_PTR lowestPass(pcb_PTR tp){
+    pcb_PTR best = headProcQ(tp);
+    pcb_PTR p;
+    if(best == NULL){
+        return NULL;
+    }
+    for(p = best->p_prev; p != best; p = p->p_prev){ /* oldest to newest */
+        if(PASSBEFORE(p->p_pass, best->p_pass)){
+            best = p;
+        }
+    }
+    return best;
+}
+#endif
+
+/* Remove the next process to run from the highest non-empty level of this
+ * processor's ready queue and claim it. p_cpu is set before the process
+ * leaves the queue, so outReady() on another processor always finds it
+ * either on the queue or claimed. */
+HIDDEN pcb_PTR nextReady(){
+    pcb_PTR next = NULL;
+    pcb_PTR *q = NULL;
+    int id = getPRID();
+    spinLock(&readyLock[id]);
+#if SCHEDPOLICY == SCHEDSTRIDE
+    q = &readyQueue[id][0];
+    next = lowestPass(*q);
+#else
+    int level;
+    for(level = 0; level < READYLEVELS && next == NULL; level++){
+        q = &readyQueue[id][level];
+        next = headProcQ(*q);
+    }
+#endif
+    if(next != NULL){
+        next->p_cpu = id;
+        outProcQ(q, next);
+        readyCount[id]--;
+#if SCHEDPOLICY == SCHEDSTRIDE
+        globalPass[id] = next->p_pass;
+#endif
+    }
+    spinUnlock(&readyLock[id]);
+    return next;
+}
+
+/* This processor has nothing ready: move half (rounded up) of the busiest
+ * other processor's ready processes, oldest first, onto its own queues.
+ * The two locks are taken lowest id first. Returns TRUE if anything moved. */
+HIDDEN int stealReady(){
+    int id = getPRID();
+    int victim = NOCPU;
+    int most = 0;
+    int moved = 0;
+    int i, level, take;
+
+    /* readyCount is only a hint here, it is checked again under the locks */
+    for(i = 0; i < ncpus; i++){
+        if(i != id && readyCount[i] > most){
+            most = readyCount[i];
+            victim = i;
+        }
+    }
+    if(victim == NOCPU){
+        return FALSE;
+    }
+
+    spinLock(&readyLock[MIN(id, victim)]);
+    spinLock(&readyLock[MAX(id, victim)]);
+    take = (readyCount[victim] + 1) / 2;
+    for(level = 0; level < READYLEVELS && moved < take; level++){
+        pcb_PTR p = removeProcQ(&readyQueue[victim][level]);
+        while(p != NULL){
+#if SCHEDPOLICY == SCHEDSTRIDE
+            /* carry its lead or lag over to this processor's passes */
+            p->p_pass += globalPass[id] - globalPass[victim];
+#endif
+            insertProcQ(&readyQueue[id][level], p);
+            readyCount[victim]--;
+            readyCount[id]++;
+            moved++;
+            p = (moved < take) ? removeProcQ(&readyQueue[victim][level]) : NULL;
+        }
+    }
+    spinUnlock(&readyLock[MAX(id, victim)]);
+    spinUnlock(&readyLock[MIN(id, victim)]);
+    if(moved > 0){
+        cpus[id].c_steals++;
+        cpus[id].c_migrations += moved;
+    }
+    return moved > 0;
+}
+
+/* The next process for this processor: a real-time one, then its own,
+ * then one stolen. */
+HIDDEN pcb_PTR takeReady(){
+    pcb_PTR next = nextRealtime();
+    if(next == NULL){
+        next = nextReady();
+    }
+    if(next == NULL && stealReady()){
+        next = nextReady();
+    }
+    return next;
+}
+
+/* TRUE if a processor other than this one is running a process. */
+HIDDEN int runningElsewhere(){
+    int id;
+    for(id = 0; id < ncpus; id++){
+        if(id != getPRID() && cpus[id].c_currentProc != NULL){
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/* Charge the time this processor spent waiting since the scheduler last
+ * found nothing to run. It ends on the first scheduler() call after the
+ * WAIT, so the interrupt handler that woke it is counted as idle too. */
+HIDDEN void endIdle(){
+    percpu_t *cpu = &cpus[getPRID()];
+    cpu_t now;
+    if(cpu->c_idle){
+        STCK(now);
+        cpu->c_idleTime += now - cpu->c_idleSince;
+        cpu->c_idle = FALSE;
+    }
+}
+
+/* BOOM! Context switch to next on this processor, for a time slice of
+ * quantum. next must already be claimed (p_cpu set) for this processor. */
+void runProc(pcb_PTR next, int quantum){
+    cpus[getPRID()].c_idlePoll = QUANTUM;
+    currentProc = next;
+    next->p_acct->a_dispatches++;
+    if(next->p_acct->a_wakeTOD != 0){
+        endWakeup(next);
+    }
+    TRACEEVENT(TRDISPATCH, next, quantum);
+    startTime = next->p_acct->a_time;
+    STCK(cpus[getPRID()].c_markTOD);
+    cpus[getPRID()].c_bucket = ACCTSYS;
+    endMasked();
+    setTIMER(quantum);
+    loadState(next->p_s);
+}
+
+/* Run next for its full quantum, longer on lower MLFQ levels. A
+ * real-time process gets what is left of its budget, up to its quantum. */
+HIDDEN void dispatch(pcb_PTR next){
+    if(next->p_acct->a_rtPeriod != 0){
+        runProc(next, MIN(next->p_acct->a_rtLeft, next->p_acct->a_quantum));
+    } else {
+        runProc(next, next->p_acct->a_quantum << next->p_level);
+    }
+}
 
 /* Start the scheduler! Round-Robin method is implemented and controls the schedule of 
- * each process that needs to be executed.
+ * each process that needs to be executed. The process that ran last on this
+ * processor has already been taken off it with stopCurrent().
  */
 void scheduler(){
-    cpu_t howManyProcessorCyclesElapsed;
-    if(currentProc != NULL){ 
-        STCK(howManyProcessorCyclesElapsed); /* STCK() stores how many processor cycles have elapsed*/
-        currentProc->p_time = currentProc->p_time + (howManyProcessorCyclesElapsed - startTOD);
-        LDIT(IOCLOCK); /* load the interval timer with IOCLOCK value */
-    }
+    endIdle();
+    runDeferred(); /* wake who the interrupts since the last pass were for */
+#if SCHEDPOLICY == SCHEDMLFQ
+    boostReady();
+#endif
     pcb_PTR next; /* next is a pointer to a pcb that will be removed from the readyQueue. */
-    next = removeProcQ(&readyQueue); /* Remove a pcb from the head of the readyQueue */
+    next = takeReady(); /* Remove a pcb from the head of the highest non-empty ready level */
     
     /* * * * If we CAN get a pcb * * * */
     if (next != NULL){ /* If there is a pcb that next can point to. */
-        currentProc = next;
-        STCK(startTOD);
-        setTIMER(QUANTUM); /* start timer for 5 ms */
-        loadState(&(currentProc->p_s)); /* BOOM! Context Switch */
+        dispatch(next);
    
         /* * * * If we CANNOT get a pcb * * * */
     } else { /* if next == NULL */
         if(processCount == 0){ /* If the readyQueue is empty so there are no more process to run! */
+            STATSDUMP();
+            TRACEDUMP();
             HALT();
         }
        
         /* The deadlock case
-         * There are processes, but they're not in the Blocked or Ready queues.
+         * There are processes, but they're not in the Blocked or Ready queues,
+         * and none is running on another processor. Look again under semLock
+         * so no process is between a processor and a queue.
          */
-        if ((softBlockCount == 0) && (processCount > 0)){
+        spinLock(&semLock);
+        next = takeReady();
+        if ((next == NULL) && (softBlockCount == 0) && (processCount > 0) && !runningElsewhere()){
              PANIC(); /* Stop, Panic time */
         }
+        spinUnlock(&semLock);
+        if (next != NULL){
+            dispatch(next);
+        }
         
-        /* If for some reason there are pcbs in the readyQueue and there are pcbs on the ASL but we can't make a pointer to it called next...*/
-        if ((softBlockCount > 0) && (processCount > 0)){ 
-            int maskForStatus = ALLOFF | IECON | IMON ;
-            setSTATUS(maskForStatus); 
-            WAIT(); /*WAIT() unblocks a pcb from the ASL and populates the readyQueue */
-            } 
+        /* Nothing to run here yet: wait for an interrupt. Processor 0 gets the
+         * device and pseudo-clock interrupts; with more than one processor the
+         * local timer also wakes each of them to look at the readyQueue again,
+         * backing off from QUANTUM to IDLEPOLLMAX while nothing turns up. */
+        int maskForStatus = ALLOFF | IECON | IMON;
+        if(ncpus > 1){
+            setTIMER(cpus[getPRID()].c_idlePoll);
+            cpus[getPRID()].c_idlePoll = MIN(2 * cpus[getPRID()].c_idlePoll, IDLEPOLLMAX);
+            maskForStatus |= TEBITON;
+        }
+        cpus[getPRID()].c_idle = TRUE;
+        STCK(cpus[getPRID()].c_idleSince);
+        endMasked();
+        setSTATUS(maskForStatus); 
+        WAIT(); /*WAIT() unblocks a pcb from the ASL and populates the readyQueue */
         }
  }
 
 
 /* BOOM! Context Switch! */
 void loadState(state_PTR ps){
+    chargeCurrent(ACCTUSER);
+    ENDSYSCALL();
+    TRACESYSEXIT(ps->s_v0);
     LDST(ps);
 }
-
-
-
-
@@ -0,0 +1,139 @@
+/************ sleepTest.c ************/
+/* Nucleus test for the timer wheel behind SLEEP (SYS28).
+ *
+ * Linked in place of initProc.c (make sleep) so test() here is the first
+ * process. It starts a CPU bound counter and times its rate alone for
+ * BASEUS, sleeping on SYS28 itself meanwhile. Then it starts SLEEPERS
+ * processes that each sleep SLEEPROUNDS times for pseudo random spans of
+ * 1 to SLEEPSPAN us and note how late they ran again: the TOD once back
+ * minus the TOD they asked to wake at. Once they are all done, test()
+ * reports on terminal 0 their average and worst lateness, how many
+ * interval timer interrupts the run took for how many sleeps, and the
+ * counter's rate meanwhile in per mille of its rate alone, what all the
+ * sleeping left it. Waking early, or later than SLEEPSLACK, fails the
+ * test. Run it on one processor. Finally test() terminates, which takes
+ * the counter with it and HALTs.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/interrupts.h"
+#include "../h/testLib.h"
+#include "../h/libumps.h"
+
+#define SLEEPERS	200
+#define SLEEPROUNDS	20
+#define SLEEPSPAN	200000	/* longest sleep in us, aka 200 ms */
+#define SLEEPSLACK	20000	/* us a sleeper may run late by */
+#define BASEUS		500000	/* us the counter is timed alone for */
+#define SLEEPSTACK	512	/* stack bytes given to each sleeper and the counter */
+
+HIDDEN int sleepDone = 0;	/* V'd by each sleeper once it is done */
+HIDDEN volatile unsigned int work;	/* iterations of the counter */
+HIDDEN int lateSum[SLEEPERS];	/* us each sleeper ran late by, all told */
+HIDDEN int lateMax[SLEEPERS];
+HIDDEN int early[SLEEPERS];	/* sleeps it came back from too soon */
+
+HIDDEN void counter()
+{
+	while (TRUE)
+		work++;
+}
+
+HIDDEN void sleeper(int n)
+{
+	unsigned int seed = (n * 2654435761U) + 1;
+	cpu_t asked, woke;
+	int span, late, i;
+
+	for (i = 0; i < SLEEPROUNDS; i++) {
+		seed = (seed * 1103515245) + 12345;
+		span = 1 + ((seed >> 8) % SLEEPSPAN);
+		STCK(asked);
+		asked += span;
+		SYSCALL(SLEEP, span, 0, 0);
+		STCK(woke);
+		late = woke - asked;
+		if (late < 0)
+			early[n]++;
+		lateSum[n] += late;
+		if (late > lateMax[n])
+			lateMax[n] = late;
+	}
+	SYSCALL(VERHOGEN, (int) &sleepDone, 0, 0);
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* Counter iterations per ms while sleeping us, or while waiting for
+ * every sleeper if us is 0. */
+HIDDEN unsigned int countRate(int us)
+{
+	cpu_t start, end;
+	unsigned int from;
+	int i;
+
+	STCK(start);
+	from = work;
+	if (us > 0) {
+		SYSCALL(SLEEP, us, 0, 0);
+	} else {
+		for (i = 0; i < SLEEPERS; i++)
+			SYSCALL(PASSEREN, (int) &sleepDone, 0, 0);
+	}
+	STCK(end);
+	return (work - from) / (((end - start) / 1000) + 1);
+}
+
+void test()
+{
+	unsigned int baseRate, loadRate, ticks, lateAll = 0, worst = 0, tooSoon = 0;
+	int i;
+
+	initSpawn(SLEEPSTACK);
+
+	print("sleepTest: ");
+	printNum(SLEEPERS);
+	print(" sleepers, ");
+	printNum(SLEEPROUNDS);
+	print(" sleeps of up to ");
+	printNum(SLEEPSPAN);
+	print(" us each\n");
+
+	spawn(counter, 0, 0);
+	baseRate = countRate(BASEUS);
+	if (baseRate == 0) {
+		print("sleepTest: the counter barely ran\n");
+		PANIC();
+	}
+
+	ticks = interruptCount[2];
+	for (i = 0; i < SLEEPERS; i++)
+		spawn(sleeper, i + 1, i);
+	loadRate = countRate(0);
+	ticks = interruptCount[2] - ticks;
+
+	for (i = 0; i < SLEEPERS; i++) {
+		lateAll += lateSum[i];
+		tooSoon += early[i];
+		if (lateMax[i] > worst)
+			worst = lateMax[i];
+	}
+
+	print("sleepTest: late by ");
+	printNum(lateAll / (SLEEPERS * SLEEPROUNDS));
+	print(" us on average, ");
+	printNum(worst);
+	print(" us at worst, ");
+	printNum(tooSoon);
+	print(" early\n");
+	print("sleepTest: ");
+	printNum(ticks);
+	print(" timer interrupts for ");
+	printNum(SLEEPERS * SLEEPROUNDS);
+	print(" sleeps, counter at ");
+	printNum((loadRate * 1000) / baseRate);
+	print(" per mille\n");
+
+	print((tooSoon > 0 || worst > SLEEPSLACK) ? "sleepTest: FAILED\n" : "sleepTest: done\n");
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
@@ -0,0 +1,28 @@
+/************ SPINLOCK.C ************/
+/*
+ * Spinlocks for the nucleus data structures the processors share.
+ *
+ * A lock is a word that is UNLOCKED or LOCKED. spinLock() busy waits until
+ * its CAS flips the word from UNLOCKED to LOCKED, spinUnlock() stores
+ * UNLOCKED back. Nucleus code runs with interrupts off, so a lock is never
+ * held across an interrupt on the same processor. Where more than one is
+ * needed they are taken in the order pcbLock, semLock, then the ready
+ * queue lock in scheduler.c.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/spinlock.h"
+#include "../h/libumps.h"
+
+
+void spinLock(spinlock_t *l){
+    while(!CAS(l, UNLOCKED, LOCKED)){
+        ;
+    }
+}
+
+
+void spinUnlock(spinlock_t *l){
+    *l = UNLOCKED;
+}
@@ -0,0 +1,89 @@
+/************ strideTest.c ************/
+/* Nucleus test for stride scheduling CPU shares.
+ *
+ * Linked in place of initProc.c (make stride SCHED=STRIDE) so test() here
+ * is the first process. It starts one CPU bound worker per entry of
+ * weights[], each of which sets its own weight with SYS21 and then counts
+ * loop iterations. test() sleeps on the pseudo-clock while they run, then
+ * compares each worker's share of the iterations with its share of the
+ * total weight and reports both on terminal 0, in tenths of a percent.
+ * Any share off by more than STRIDESLACK fails the test. Run it on one
+ * processor: with more, every worker gets a processor of its own. Finally
+ * test() terminates, which takes the workers with it and HALTs.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/testLib.h"
+#include "../h/libumps.h"
+
+#define STRIDEWORKERS	3
+#define STRIDEWARMUP	2	/* pseudo-clock ticks before counting starts */
+#define STRIDETICKS	30	/* pseudo-clock ticks counted, aka 3 s */
+#define STRIDESLACK	30	/* per mille a share may be off by */
+#define STRIDESTACK	1024	/* stack bytes given to each worker */
+
+HIDDEN int weights[STRIDEWORKERS] = {10, 20, 40};
+HIDDEN volatile unsigned int work[STRIDEWORKERS];	/* iterations of each worker */
+
+HIDDEN void worker(int n)
+{
+	if (SYSCALL(SETWEIGHT, weights[n], 0, 0) != 0) {
+		print("strideTest: SYS21 refused a weight\n");
+		PANIC();
+	}
+	while (TRUE)
+		work[n]++;
+}
+
+void test()
+{
+	unsigned int counted[STRIDEWORKERS];
+	unsigned int total = 0, weightSum = 0, got, want;
+	int failed = FALSE;
+	int i;
+
+	initSpawn(STRIDESTACK);
+
+	print("strideTest: CPU shares of workers with weights");
+	for (i = 0; i < STRIDEWORKERS; i++) {
+		print(" ");
+		printNum(weights[i]);
+		spawn(worker, i, i);
+	}
+	print("\n");
+
+	/* Let every worker set its weight before counting. */
+	for (i = 0; i < STRIDEWARMUP; i++)
+		SYSCALL(WAITCLOCK, 0, 0, 0);
+	for (i = 0; i < STRIDEWORKERS; i++)
+		counted[i] = work[i];
+	for (i = 0; i < STRIDETICKS; i++)
+		SYSCALL(WAITCLOCK, 0, 0, 0);
+	for (i = 0; i < STRIDEWORKERS; i++) {
+		counted[i] = work[i] - counted[i];
+		total += counted[i];
+		weightSum += weights[i];
+	}
+	if (total < 1000) {
+		print("strideTest: the workers barely ran\n");
+		PANIC();
+	}
+
+	for (i = 0; i < STRIDEWORKERS; i++) {
+		got = counted[i] / (total / 1000);
+		want = (weights[i] * 1000) / weightSum;
+		print("strideTest: weight ");
+		printNum(weights[i]);
+		print(" wanted ");
+		printNum(want);
+		print(" got ");
+		printNum(got);
+		print(" per mille\n");
+		if (got + STRIDESLACK < want || got > want + STRIDESLACK)
+			failed = TRUE;
+	}
+
+	print(failed ? "strideTest: FAILED\n" : "strideTest: done\n");
+	SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
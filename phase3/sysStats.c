@@ -0,0 +1,180 @@
+/************ SYSSTATS.C ************/
+/*
+ * Syscall counters and latency histograms, built only with SYSSTATS TRUE
+ * (make SYSSTATS=TRUE).
+ *
+ * SYSCALLHandler() stamps the TOD when a kernel mode syscall comes in and
+ * the first way out of the nucleus after it (loadState, stopCurrent or a
+ * pass up) closes it, so a blocking syscall is timed up to the point the
+ * caller is parked, not until it runs again. Each processor has its own
+ * block, so nothing here takes a lock: bucket b of a histogram counts
+ * calls that took 2^b to 2^(b+1) - 1 us, bucket 0 those under 2 us.
+ *
+ * dumpSysStats() adds the blocks up and writes them out, busy waiting on
+ * terminal 0 or printer 0 (SYSSTATSOUT). scheduler() calls it just before
+ * HALT, and DUMPSYSSTATS (SYS26) asks for it at any time, with semLock
+ * held. It only writes while the device is READY and nobody waits on its
+ * semaphore: a command of its own would overwrite a process's, and its
+ * ACK would take the interrupt that process is waiting for. Once the
+ * device turns out to be in use, the rest of the dump is dropped and
+ * dumpSysStats() returns FALSE.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/initial.h"
+#include "../h/sysStats.h"
+#include "../h/libumps.h"
+
+#if SYSSTATS
+
+typedef struct sysstats_t {
+    unsigned int s_calls[MAXSYSCALL];
+    unsigned int s_hist[MAXSYSCALL][STATBUCKETS];
+} sysstats_t;
+
+HIDDEN sysstats_t sysStats[MAXCPUS];
+HIDDEN int sysNumber[MAXCPUS]; /* syscall each processor is in, 0 if none */
+HIDDEN cpu_t sysStart[MAXCPUS]; /* TOD it came in */
+HIDDEN int statBusy; /* TRUE once the device was found in use during this dump */
+
+/* the device the dump goes to and the semaphore WAITIO uses for it */
+#if SYSSTATSOUT == STATSPRINTER
+#define STATLINE PRNTINT
+#else
+#define STATLINE TERMINT
+#endif
+#define STATDEV ((device_t *) (DEVICEREGISTERSBUSAREA + ((STATLINE - DISKINT) * DEVPERINT * DEVREGSIZE)))
+#define STATSEM (semDevices[(STATLINE - DISKINT) * DEVPERINT])
+
+
+/* A kernel mode syscall number came in on this processor. */
+void beginSyscall(int number){
+    int id = getPRID();
+    if(number > 0 && number < MAXSYSCALL){
+        sysNumber[id] = number;
+        STCK(sysStart[id]);
+    }
+}
+
+
+/* Leaving the nucleus: count the syscall this processor was in, if any. */
+void endSyscall(){
+    int id = getPRID();
+    int number = sysNumber[id];
+    int bucket = 0;
+    cpu_t took;
+    if(number == 0){
+        return;
+    }
+    STCK(took);
+    took -= sysStart[id];
+    while(took > 1 && bucket < STATBUCKETS - 1){
+        took >>= 1;
+        bucket++;
+    }
+    sysStats[id].s_calls[number]++;
+    sysStats[id].s_hist[number][bucket]++;
+    sysNumber[id] = 0;
+}
+
+
+/* Write one character, waiting for the device instead of its interrupt,
+ * unless a process has the device: then drop it and the rest of the dump. */
+HIDDEN void statPutc(char c){
+    device_t *dev = STATDEV;
+#if SYSSTATSOUT == STATSPRINTER
+    if(statBusy || STATSEM < 0 || (dev->d_status & TERMSTATMASK) != READY){
+        statBusy = TRUE;
+        return;
+    }
+    dev->d_data0 = c;
+    dev->d_command = PRINTCHR;
+    while((dev->d_status & TERMSTATMASK) == BUSY){
+        ;
+    }
+    dev->d_command = ACK;
+#else
+    if(statBusy || STATSEM < 0 || (dev->t_transm_status & TERMSTATMASK) != READY){
+        statBusy = TRUE;
+        return;
+    }
+    dev->t_transm_command = PRINTCHR | (((unsigned int) c) << BYTELENGTH);
+    while((dev->t_transm_status & TERMSTATMASK) == BUSY){
+        ;
+    }
+    dev->t_transm_command = ACK;
+#endif
+}
+
+HIDDEN void statPuts(char *s){
+    while(*s != EOS){
+        statPutc(*s++);
+    }
+}
+
+HIDDEN void statPutNum(unsigned int n){
+    char buf[11];
+    int i = 10;
+    buf[i] = EOS;
+    do {
+        buf[--i] = '0' + (n % 10);
+        n /= 10;
+    } while(n > 0);
+    statPuts(&buf[i]);
+}
+
+
+/* Write every syscall that was called at least once, one line each:
+ * "sys N: C calls, log2 us b:count ...", skipping empty buckets, then
+ * how many interrupts each processor serviced per IOHandler() entry and
+ * the longest it kept interrupts masked after taking one. FALSE if the
+ * device was in use, so not all of it was written. */
+int dumpSysStats(){
+    int number, bucket, id;
+    statBusy = FALSE;
+    statPuts("syscall latency, all processors\n");
+    for(number = 1; number < MAXSYSCALL; number++){
+        unsigned int calls = 0;
+        for(id = 0; id < ncpus; id++){
+            calls += sysStats[id].s_calls[number];
+        }
+        if(calls == 0){
+            continue;
+        }
+        statPuts("sys ");
+        statPutNum(number);
+        statPuts(": ");
+        statPutNum(calls);
+        statPuts(" calls, log2 us");
+        for(bucket = 0; bucket < STATBUCKETS; bucket++){
+            unsigned int count = 0;
+            for(id = 0; id < ncpus; id++){
+                count += sysStats[id].s_hist[number][bucket];
+            }
+            if(count != 0){
+                statPuts(" ");
+                statPutNum(bucket);
+                statPuts(":");
+                statPutNum(count);
+            }
+        }
+        statPuts("\n");
+    }
+    for(id = 0; id < ncpus; id++){
+        statPuts("cpu ");
+        statPutNum(id);
+        statPuts(": ");
+        statPutNum(cpus[id].c_intEntries);
+        statPuts(" interrupt entries, ");
+        statPutNum(cpus[id].c_intServiced);
+        statPuts(" serviced, at most ");
+        statPutNum(cpus[id].c_intBatchMax);
+        statPuts(" in one, interrupts masked up to ");
+        statPutNum(cpus[id].c_maskedMax);
+        statPuts(" us after one\n");
+    }
+    return !statBusy;
+}
+
+#endif
@@ -16,6 +16,11 @@
 #include "../h/libumps.h"
 #include "../h/vmSupport.h"
 
+/* Semaphores every U-proc can reach by number with SYS19/SYS20. They
+ * stand in for semaphores in a shared segment, which this support level
+ * does not map, and all start at 0. */
+HIDDEN int sharedSems[SHAREDSEMS];
+
 void SysSupport(){
    support_t* supportStruct = SYSCALL(GETSUPPORTPTR, ZERO, ZERO, ZERO);
    state_PTR exceptionState = &supportStruct->sup_exceptState[GENERALEXCEPT];
@@ -55,6 +60,45 @@ void uSysHandler(support_t *supportStruct){
       case READFROMTERMINAL: /* SYS 13: Read to the terminal */
         exceptionState->s_v0 =  readFromTerminal(arg1);
         break;
+      case PSEMVIRT: /* SYS 19: P on a shared semaphore */
+      case VSEMVIRT: /* SYS 20: V on a shared semaphore */
+        if(arg1 < 0 || arg1 >= SHAREDSEMS){
+          exceptionState->s_v0 = -1;
+        } else {
+          SYSCALL((syscallNumber == PSEMVIRT) ? PASSEREN : VERHOGEN, (int) &sharedSems[arg1], ZERO, ZERO);
+          exceptionState->s_v0 = 0;
+        }
+        break;
+      case SETWEIGHT: /* SYS 21: Set this U-proc's share of the CPU, done by the nucleus */
+        exceptionState->s_v0 = SYSCALL(SETWEIGHT, arg1, ZERO, ZERO);
+        break;
+      case SETREALTIME: /* SYS 22: Declare a period and budget, admitted by the nucleus */
+        exceptionState->s_v0 = SYSCALL(SETREALTIME, arg1, arg2, ZERO);
+        break;
+      case GETRTSTATS: /* SYS 23: Get deadline misses from the nucleus */
+        exceptionState->s_v0 = SYSCALL(GETRTSTATS, arg1, ZERO, ZERO);
+        break;
+      case GETCPUSTATS: /* SYS 24: Get cpu time by bucket from the nucleus */
+        exceptionState->s_v0 = SYSCALL(GETCPUSTATS, arg1, ZERO, ZERO);
+        break;
+      case SETQUANTUM: /* SYS 25: Set this U-proc's time slice, done by the nucleus */
+        exceptionState->s_v0 = SYSCALL(SETQUANTUM, arg1, ZERO, ZERO);
+        break;
+      case DUMPSYSSTATS: /* SYS 26: Have the nucleus write its syscall stats out */
+        exceptionState->s_v0 = SYSCALL(DUMPSYSSTATS, ZERO, ZERO, ZERO);
+        break;
+      case GETINTLATENCY: /* SYS 27: Get a device's interrupt latency statistics from the nucleus */
+        exceptionState->s_v0 = SYSCALL(GETINTLATENCY, arg1, arg2, arg3);
+        break;
+      case DELAY: /* SYS 18: Sleep for a1 seconds on the nucleus timer wheel, a negative a1 is fatal */
+        if(arg1 < 0){
+          terminateProcess(processASID);
+        }
+        if(arg1 > MAXDELAY){
+          arg1 = MAXDELAY; /* longer delays are cut down rather than overflow the us count */
+        }
+        exceptionState->s_v0 = SYSCALL(SLEEP, arg1 * SECOND, ZERO, ZERO);
+        break;
       default:
         terminateProcess(processASID); /* If none of the above match the syscallNumber, terminate the process. */
        }
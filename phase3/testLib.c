@@ -0,0 +1,83 @@
+/************ testLib.c ************/
+/* What the nucleus tests linked in place of initProc.c share.
+ *
+ * print() and printNum() write on terminal 0 the way p2test does, one
+ * character per WAITIO under termMutex. initSpawn() marks where the
+ * children's stacks start, a page below the caller's own stack, and
+ * trySpawn() starts fn(arg) as a child on stack slot slot from there,
+ * each slot stackBytes further down.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/testLib.h"
+#include "../h/libumps.h"
+
+HIDDEN int termMutex = 1;	/* mutual exclusion on terminal 0 */
+HIDDEN memaddr spawnStackTop;	/* stack slot 0 */
+HIDDEN int spawnStack;		/* stack bytes given to each slot */
+
+/* Print a string on terminal 0, like p2test does. */
+void print(char *msg)
+{
+	char *s = msg;
+	device_t *term = (device_t *) TERM0ADDR;
+	unsigned int status;
+
+	SYSCALL(PASSEREN, (int) &termMutex, 0, 0);
+	while (*s != EOS) {
+		term->t_transm_command = PRINTCHR | (((unsigned int) *s) << BYTELENGTH);
+		status = SYSCALL(WAITIO, TERMINT, 0, 0);
+		if ((status & TERMSTATMASK) != RECVD)
+			PANIC();
+		s++;
+	}
+	SYSCALL(VERHOGEN, (int) &termMutex, 0, 0);
+}
+
+void printNum(unsigned int n)
+{
+	char buf[11];
+	int i = 10;
+
+	buf[i] = EOS;
+	do {
+		buf[--i] = '0' + (n % 10);
+		n /= 10;
+	} while (n > 0);
+	print(&buf[i]);
+}
+
+/* Called first thing in test(): children get stackBytes each, from a
+ * page below test()'s stack down. */
+void initSpawn(int stackBytes)
+{
+	state_t myState;
+
+	STST(&myState);
+	spawnStackTop = myState.s_sp - PAGESIZE;
+	spawnStack = stackBytes;
+}
+
+/* Start fn(arg) on the slot-th stack below test()'s, returning what
+ * SYS1 did. */
+int trySpawn(void (*fn)(), int slot, int arg)
+{
+	state_t childState;
+
+	STST(&childState);
+	childState.s_sp = spawnStackTop - (slot * spawnStack);
+	childState.s_pc = childState.s_t9 = (memaddr) fn;
+	childState.s_a0 = arg;
+	childState.s_status = ALLOFF | IEON | IMON | TEBITON;
+	return SYSCALL(CREATEPROCESS, (int) &childState, 0, 0);
+}
+
+/* trySpawn(), where failing to start the child fails the test. */
+void spawn(void (*fn)(), int slot, int arg)
+{
+	if (trySpawn(fn, slot, arg) != 0) {
+		print("could not create a process\n");
+		PANIC();
+	}
+}
@@ -0,0 +1,144 @@
+/************ TIMER.C ************/
+/*
+ * The nucleus timer wheel, behind SLEEP (SYS28).
+ *
+ * Time is cut into TIMERTICK us ticks, and a sleeper waits for the
+ * first tick at or after its wake up time on a two level
+ * hierarchical wheel. Level 0 has a slot for each of the next WHEELSLOTS
+ * ticks, level 1 one for each of the next WHEELSLOTS runs of WHEELSLOTS
+ * ticks, and anything further out waits on wheelFar. Whenever level 0
+ * comes round, the level 1 slot for the run starting is emptied into
+ * level 0, and whenever level 1 comes round wheelFar is filed into the
+ * wheel again. A tick thus only touches the processes due then, plus now
+ * and again the ones moving down a level, however many sleep.
+ *
+ * The wheel turns only when the interval timer goes off: armClock() in
+ * interrupts.c asks nextTimer() for the next level 0 slot with sleepers
+ * in it, or the next time level 0 comes round, so nothing ticks while
+ * nobody sleeps. Everything here is called with semLock held.
+ *
+ * Ticks are counted by the wheel itself rather than read off the TOD
+ * clock: wheelTOD is the TOD tick wheelNow fell due at, and every turn
+ * moves both on by one tick, so only TOD differences are ever taken and
+ * the count runs on smoothly when the TOD low word wraps.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/pcb.h"
+#include "../h/scheduler.h"
+#include "../h/initial.h"
+#include "../h/timer.h"
+#include "../h/libumps.h"
+
+HIDDEN pcb_PTR wheel[WHEELLEVELS][WHEELSLOTS]; /* tail pointers of the slot queues */
+HIDDEN pcb_PTR wheelFar; /* sleepers due past the end of level 1 */
+HIDDEN unsigned int wheelNow; /* tick the wheel has been turned to */
+HIDDEN cpu_t wheelTOD; /* TOD tick wheelNow fell due at */
+HIDDEN int sleepers;
+
+
+void initTimers(){
+    cpu_t now;
+    int level, slot;
+    for(level = 0; level < WHEELLEVELS; level++){
+        for(slot = 0; slot < WHEELSLOTS; slot++){
+            wheel[level][slot] = mkEmptyProcQ();
+        }
+    }
+    wheelFar = mkEmptyProcQ();
+    sleepers = 0;
+    wheelNow = 0;
+    STCK(now);
+    wheelTOD = now;
+}
+
+/* Put p on the slot its a_sleepTick falls in, seen from wheelNow. */
+HIDDEN void fileSleeper(pcb_PTR p){
+    unsigned int ahead = p->p_acct->a_sleepTick - wheelNow;
+    if(ahead < WHEELSLOTS){
+        insertProcQ(&wheel[0][p->p_acct->a_sleepTick % WHEELSLOTS], p);
+    } else if(ahead < WHEELSLOTS * WHEELSLOTS){
+        insertProcQ(&wheel[1][(p->p_acct->a_sleepTick / WHEELSLOTS) % WHEELSLOTS], p);
+    } else {
+        insertProcQ(&wheelFar, p);
+    }
+}
+
+/* File every sleeper on *q again, now that the wheel has moved on. */
+HIDDEN void refile(pcb_PTR *q){
+    pcb_PTR list = *q;
+    pcb_PTR p;
+    *q = mkEmptyProcQ();
+    while((p = removeProcQ(&list)) != NULL){
+        fileSleeper(p);
+    }
+}
+
+/* Turn the wheel one tick and wake whoever is due then. */
+HIDDEN void turnWheel(){
+    pcb_PTR p;
+    wheelNow++;
+    wheelTOD += TIMERTICK;
+    if(wheelNow % (WHEELSLOTS * WHEELSLOTS) == 0){
+        refile(&wheelFar);
+    }
+    if(wheelNow % WHEELSLOTS == 0){
+        refile(&wheel[1][(wheelNow / WHEELSLOTS) % WHEELSLOTS]);
+    }
+    while((p = removeProcQ(&wheel[0][wheelNow % WHEELSLOTS])) != NULL){
+        p->p_acct->a_sleepTick = 0;
+        sleepers--;
+        softBlockCount--;
+        readyProc(p);
+    }
+}
+
+/* Put p, already off its processor, to sleep for us microseconds. It
+ * counts as soft blocked until it wakes; the caller calls armClock(). */
+void addSleeper(pcb_PTR p, cpu_t us){
+    cpu_t now;
+    unsigned int ahead;
+    STCK(now);
+    if(sleepers == 0){
+        wheelTOD = now; /* the wheel stood still while empty, so catch it up */
+    }
+    ahead = ((unsigned int) (now - wheelTOD) + (unsigned int) us + TIMERTICK - 1) / TIMERTICK;
+    if(ahead == 0){
+        ahead = 1; /* the tick due now has been turned already */
+    }
+    p->p_acct->a_sleepTick = wheelNow + ahead;
+    fileSleeper(p);
+    sleepers++;
+    softBlockCount++;
+}
+
+/* Take p, which is being terminated, off the wheel. */
+void cancelSleeper(pcb_PTR p){
+    outProcQ(p->p_queue, p);
+    p->p_acct->a_sleepTick = 0;
+    sleepers--;
+    softBlockCount--;
+}
+
+/* Turn the wheel up to the TOD now, waking every sleeper due by then. */
+void expireTimers(cpu_t now){
+    while(sleepers > 0 && !TODBEFORE(now, wheelTOD + TIMERTICK)){
+        turnWheel();
+    }
+}
+
+/* If anyone sleeps, set *when to the TOD the wheel next has to turn at
+ * and return TRUE: the next level 0 slot with sleepers, or the next time
+ * level 0 comes round if that is sooner. */
+int nextTimer(cpu_t *when){
+    unsigned int tick = wheelNow + 1;
+    if(sleepers == 0){
+        return FALSE;
+    }
+    while(tick % WHEELSLOTS != 0 && emptyProcQ(wheel[0][tick % WHEELSLOTS])){
+        tick++;
+    }
+    *when = wheelTOD + (tick - wheelNow) * TIMERTICK;
+    return TRUE;
+}
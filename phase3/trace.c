@@ -0,0 +1,124 @@
+/************ TRACE.C ************/
+/*
+ * The event trace ring, built only with TRACE TRUE (make TRACE=TRUE).
+ *
+ * Each processor gets a ring of TRACESIZE events in a frame of its own,
+ * taken from allocFrame() at boot so the rings cost the kernel image
+ * nothing, and traceBuf only keeps where they are. Logging takes no lock:
+ * a processor stores the raw TOD low word (no division by the time
+ * scale), the type and two words at t_next & (TRACESIZE - 1) and bumps
+ * t_next. Older events are overwritten. The hooks sit in runProc()
+ * (dispatch), insertBlocked()/removeBlocked(), IOHandler(), the pager
+ * (faults and evictions) and around kernel mode syscalls.
+ *
+ * To read it, either dump RAM and let bench/traceDecode find traceBuf by
+ * its t_magic, or let the nucleus write it to printer 0 as text when it
+ * HALTs (dumpTrace) and decode the printer's log file.
+ */
+
+#include "../h/const.h"
+#include "../h/types.h"
+#include "../h/initial.h"
+#include "../h/frame.h"
+#include "../h/trace.h"
+#include "../h/libumps.h"
+
+#if TRACE
+
+tracebuf_t traceBuf;
+HIDDEN unsigned int traceSys[MAXCPUS]; /* syscall each processor is in, 0 if none */
+
+
+/* Give each of the ncpus processors a ring. Processors past the last
+ * frame there was room for log nothing. */
+void initTrace(){
+    int id;
+    traceBuf.t_magic = TRACEMAGIC;
+    traceBuf.t_timescale = *((cpu_t *) TIMESCALEADDR);
+    traceBuf.t_size = TRACESIZE;
+    for(id = 0; id < ncpus; id++){
+        traceBuf.t_ring[id] = allocFrame();
+        if(traceBuf.t_ring[id] == (memaddr) NULL){
+            break;
+        }
+    }
+    traceBuf.t_ncpus = id;
+}
+
+
+void traceEvent(unsigned int type, unsigned int a, unsigned int b){
+    int id = getPRID();
+    traceevent_t *e;
+    if(id >= traceBuf.t_ncpus){
+        return; /* before initTrace(), or no ring for this processor */
+    }
+    e = &((traceevent_t *) traceBuf.t_ring[id])[traceBuf.t_next[id]++ & (TRACESIZE - 1)];
+    e->e_tod = *((cpu_t *) TODLOADDR);
+    e->e_type = type;
+    e->e_a = a;
+    e->e_b = b;
+    if(type == TRSYSENTER){
+        traceSys[id] = a;
+    }
+}
+
+
+/* Leaving the nucleus: log the end of the syscall this processor was in, if any. */
+void traceSysExit(unsigned int v0){
+    int id = getPRID();
+    if(traceSys[id] != 0){
+        traceEvent(TRSYSEXIT, traceSys[id], v0);
+        traceSys[id] = 0;
+    }
+}
+
+
+/* Write one character to printer 0, waiting for it instead of its interrupt. */
+HIDDEN void tracePutc(char c){
+    device_t *dev = (device_t *) (DEVICEREGISTERSBUSAREA + ((PRNTINT - DISKINT) * DEVPERINT * DEVREGSIZE));
+    dev->d_data0 = c;
+    dev->d_command = PRINTCHR;
+    while((dev->d_status & TERMSTATMASK) == BUSY){
+        ;
+    }
+    dev->d_command = ACK;
+}
+
+HIDDEN void tracePutHex(unsigned int n){
+    int shift;
+    for(shift = 28; shift >= 0; shift -= 4){
+        tracePutc("0123456789abcdef"[(n >> shift) & 0xF]);
+    }
+    tracePutc(' ');
+}
+
+
+/* Write traceBuf to printer 0 as text: a "T" line with the time scale,
+ * ring size and processor count, then an "E" line per event still in a
+ * ring, oldest first: processor, TOD, type, a, b, all in hex. */
+void dumpTrace(){
+    unsigned int i, first;
+    int id;
+    tracePutc('T');
+    tracePutc(' ');
+    tracePutHex(traceBuf.t_timescale);
+    tracePutHex(TRACESIZE);
+    tracePutHex(traceBuf.t_ncpus);
+    tracePutc('\n');
+    for(id = 0; id < traceBuf.t_ncpus; id++){
+        first = (traceBuf.t_next[id] > TRACESIZE) ? traceBuf.t_next[id] - TRACESIZE : 0;
+        for(i = first; i < traceBuf.t_next[id]; i++){
+            traceevent_t *e = &((traceevent_t *) traceBuf.t_ring[id])[i & (TRACESIZE - 1)];
+            tracePutc('E');
+            tracePutc(' ');
+            tracePutHex(id);
+            tracePutHex(e->e_tod);
+            tracePutHex(e->e_type);
+            tracePutHex(e->e_a);
+            tracePutHex(e->e_b);
+            tracePutc('\n');
+        }
+    }
+}
+
+#endif
@@ -15,6 +15,7 @@
 #include "../h/initProc.h"
 #include "../h/vmSupport.h"
 #include "../h/sysSupport.h" 
+#include "../h/trace.h"
 #include "../h/libumps.h"
 
 HIDDEN void flashIO(int writeOrRead, int blockNumber, memaddr data, int flashDeviceNumber);
@@ -41,7 +42,7 @@ void initTLB() {
 void uTLBRefillHandler() {
 	state_PTR oldState;
 	int pageNumber;
-	oldState = (state_PTR)BIOSDATAPAGE;
+	oldState = EXCSTATE;
   /* Locate the correct page table entry in the current process' page table. */
 	pageNumber = (((oldState -> s_entryHI) & TURNOFFVPNBITS) >> VIRTSHIFT);
 	pageNumber = (pageNumber % PAGEMAX);
@@ -75,6 +76,7 @@ void pager(){
     /* If frame i is currently occupied, assume it is occupied by logical page number k belonging to process x (ASID) and that it is “dirty” (i.e. been modified): */
     if(swapPool[frame].sw_asid != -1){
         interruptsSwitch(0);
+        TRACEEVENT(TREVICT, swapPool[frame].sw_asid, swapPool[frame].sw_pageNo);
         swapPool[frame].sw_pte->entryLO &= ~(VALIDON);
         TLBCLR();
         interruptsSwitch(1);
@@ -88,14 +90,15 @@ void pager(){
     swapPool[frame].sw_pageNo = missingPageNumber;
     /* Update the Current Process’ Page Table entry for page p to indicate it is now present (V bit) and occupying frame i (PFN field). */
     swapPool[frame].sw_pte = &(support[support->sup_asid-ONE].sup_privatePgTbl[missingPageNumber]);
-    interruptsSwitch(0);
+    interruptsSwitch(0); /* also keeps the trace hook on this processor's ring */
+    TRACEEVENT(TRPAGEFAULT, support->sup_asid, missingPageNumber);
     swapPool[frame].sw_pte->entryLO = page | DIRTYON | VALIDON;
     TLBCLR();
     interruptsSwitch(1);
     /* Release mutual exclusion over the Swap Pool table. (SYS4 – V operation on the Swap Pool semaphore) */
     SYSCALL(VERHOGEN, &swapperSema4, ZERO, ZERO);
     /* Return control to the Current Process to retry the instruction that caused the page fault: LDST on the saved exception state. */
-    LDST(BIOSDATAPAGE);
+    LDST(EXCSTATE);
   } else {   /* If the Cause is a TLB-Modification exception, treat this exception as a program trap [Section 4.8], otherwise continue. */
 		SYSCALL(TERMINATE, ZERO, ZERO, ZERO);
 	}
@@ -0,0 +1,36 @@
+/*	Benchmark: device interrupt flood
+ *
+ *	Alternates SYS11 and SYS12 writes of LINELEN characters to the
+ *	U-proc's printer and terminal, ROUNDS times each, and reports
+ *	"BENCH flood n us" for the n characters written. Every character
+ *	is one device interrupt, so loaded on all eight flash devices it
+ *	keeps sixteen devices on two lines interrupting at once.
+ */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define ROUNDS	25
+#define LINELEN	16
+
+void main() {
+	char line[LINELEN + 1];
+	unsigned int start, end;
+	int i;
+
+	for (i = 0; i < LINELEN - 1; i++)
+		line[i] = '0' + (i % 10);
+	line[LINELEN - 1] = '\n';
+	line[LINELEN] = EOS;
+
+	start = SYSCALL(GET_TOD, 0, 0, 0);
+	for (i = 0; i < ROUNDS; i++) {
+		print(WRITEPRINTER, line);
+		print(WRITETERMINAL, line);
+	}
+	end = SYSCALL(GET_TOD, 0, 0, 0);
+
+	printBench("flood", 2 * ROUNDS * LINELEN, end - start);
+	SYSCALL(TERMINATE, 0, 0, 0);
+}
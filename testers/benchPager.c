@@ -0,0 +1,40 @@
+/*	Benchmark: page fault service time
+ *
+ *	Writes the first word of FAULTPAGES pages of kuseg in turn,
+ *	FAULTSWEEPS times over. FAULTPAGES is more than the whole swap pool,
+ *	and the pager replaces frames round robin, so as long as no other
+ *	U-proc is paging every write misses and the pager has to write a
+ *	page out and read one in. Reports "BENCH pagefault n us" for the
+ *	n writes of the sweeps after the first, which only fills the pool.
+ */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define FAULTFIRST	8	/* first page written, past the program */
+#define FAULTPAGES	20
+#define FAULTSWEEPS	5
+
+void sweep(int pass) {
+	int i;
+
+	for (i = FAULTFIRST; i < FAULTFIRST + FAULTPAGES; i++)
+		*(int *)(SEG2 + (i * PAGESIZE)) = pass;
+}
+
+void main() {
+	unsigned int start, end;
+	int pass;
+
+	sweep(0);
+	start = SYSCALL(GET_TOD, 0, 0, 0);
+	for (pass = 1; pass < FAULTSWEEPS; pass++)
+		sweep(pass);
+	end = SYSCALL(GET_TOD, 0, 0, 0);
+
+	if (*(int *)(SEG2 + (FAULTFIRST * PAGESIZE)) != FAULTSWEEPS - 1)
+		print(WRITETERMINAL, "benchPager error: swapper corrupted data\n");
+	printBench("pagefault", (FAULTSWEEPS - 1) * FAULTPAGES, end - start);
+	SYSCALL(TERMINATE, 0, 0, 0);
+}
@@ -0,0 +1,30 @@
+/*	Benchmark: P/V ping-pong between two U-procs, pinger half
+ *
+ *	Load it together with benchPong. Each round trip Vs shared
+ *	semaphore PINGSEM (SYS20) and Ps PONGSEM (SYS19), which benchPong
+ *	answers, so one round trip is two wakeups across U-procs. Reports
+ *	"BENCH pingpong n us" for PINGROUNDS round trips.
+ */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define PINGROUNDS	500
+#define PINGSEM		0
+#define PONGSEM		1
+
+void main() {
+	unsigned int start, end;
+	int i;
+
+	start = SYSCALL(GET_TOD, 0, 0, 0);
+	for (i = 0; i < PINGROUNDS; i++) {
+		SYSCALL(VSEMVIRT, PINGSEM, 0, 0);
+		SYSCALL(PSEMVIRT, PONGSEM, 0, 0);
+	}
+	end = SYSCALL(GET_TOD, 0, 0, 0);
+
+	printBench("pingpong", PINGROUNDS, end - start);
+	SYSCALL(TERMINATE, 0, 0, 0);
+}
@@ -0,0 +1,23 @@
+/*	Benchmark: P/V ping-pong between two U-procs, ponger half
+ *
+ *	Answers every V of benchPing on PINGSEM with a V on PONGSEM, then
+ *	terminates. Reports nothing itself.
+ */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define PINGROUNDS	500
+#define PINGSEM		0
+#define PONGSEM		1
+
+void main() {
+	int i;
+
+	for (i = 0; i < PINGROUNDS; i++) {
+		SYSCALL(PSEMVIRT, PINGSEM, 0, 0);
+		SYSCALL(VSEMVIRT, PONGSEM, 0, 0);
+	}
+	SYSCALL(TERMINATE, 0, 0, 0);
+}
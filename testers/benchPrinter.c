@@ -0,0 +1,32 @@
+/*	Benchmark: printer output bandwidth
+ *
+ *	Writes LINES lines of LINELEN characters to the U-proc's printer
+ *	with SYS11 and reports "BENCH printer n us" for the n bytes
+ *	written.
+ */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define LINES	20
+#define LINELEN	40
+
+void main() {
+	char line[LINELEN + 1];
+	unsigned int start, end;
+	int i;
+
+	for (i = 0; i < LINELEN - 1; i++)
+		line[i] = 'a' + (i % 26);
+	line[LINELEN - 1] = '\n';
+	line[LINELEN] = EOS;
+
+	start = SYSCALL(GET_TOD, 0, 0, 0);
+	for (i = 0; i < LINES; i++)
+		print(WRITEPRINTER, line);
+	end = SYSCALL(GET_TOD, 0, 0, 0);
+
+	printBench("printer", LINES * LINELEN, end - start);
+	SYSCALL(TERMINATE, 0, 0, 0);
+}
@@ -0,0 +1,25 @@
+/*	Benchmark: support level syscall round trip
+ *
+ *	Times SYSCALLS calls of GET_TOD (SYS10), each passed up by the
+ *	nucleus to the support level and back, and reports
+ *	"BENCH syscall n us".
+ */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define SYSCALLS	1000
+
+void main() {
+	unsigned int start, end;
+	int i;
+
+	start = SYSCALL(GET_TOD, 0, 0, 0);
+	for (i = 0; i < SYSCALLS; i++)
+		SYSCALL(GET_TOD, 0, 0, 0);
+	end = SYSCALL(GET_TOD, 0, 0, 0);
+
+	printBench("syscall", SYSCALLS, end - start);
+	SYSCALL(TERMINATE, 0, 0, 0);
+}
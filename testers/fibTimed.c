@@ -0,0 +1,40 @@
+/*	CPU bound job that reports when it finished
+ *
+ *	Computes Fib(FIBN) FIBREPS times and prints the TOD at which it was
+ *	done. Load it on every flash device: the largest time printed is how
+ *	long the whole batch took, so running it on 1, 2, 4 and 8 processors
+ *	shows how the nucleus scales.
+ */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define FIBN	15
+#define FIBREPS	20
+
+int fib (int i) {
+	if ((i == 1) || (i ==2))
+		return (1);
+
+	return(fib(i-1)+fib(i-2));
+}
+
+void main() {
+	int i;
+
+	print(WRITETERMINAL, "fibTimed starts\n");
+
+	for (i = 0; i < FIBREPS; i++) {
+		if (fib(FIBN) != 610) {
+			print(WRITETERMINAL, "ERROR: Recursion problems\n");
+			SYSCALL(TERMINATE, 0, 0, 0);
+		}
+	}
+
+	print(WRITETERMINAL, "fibTimed done at ");
+	printNum(SYSCALL(GET_TOD, 0, 0, 0));
+	print(WRITETERMINAL, " us\n");
+
+	SYSCALL(TERMINATE, 0, 0, 0);
+}
@@ -7,6 +7,8 @@
 */
 
 extern void print (int device, char *str);
+extern void printNum (unsigned int n);
+extern void printBench (char *name, unsigned int n, unsigned int us);
 
 /***************************************************************/
 
@@ -28,9 +28,40 @@
 #define DISK_PUT		15
 #define	FLASH_GET		16
 #define FLASH_PUT		17
-#define DELAY			18
+#define DELAY			18	/* a1 seconds, at most MAXDELAY */
 #define PSEMVIRT		19
 #define VSEMVIRT		20
+#define SETWEIGHT		21
+#define SETREALTIME		22
+#define GETRTSTATS		23
+#define GETCPUSTATS		24
+#define SETQUANTUM		25
+#define DUMPSYSSTATS	26
+#define GETINTLATENCY	27
+
+/* GETCPUSTATS a1 */
+#define CPUUSER			0
+#define CPUNUCLEUS		1
+#define CPUINTERRUPT	2
+#define CPUALL			3
+#define CPUDISPATCHES	4
+
+/* GETINTLATENCY a3, LATACK added for the time to the acknowledgement */
+#define LATCOUNT		0
+#define LATMIN			1
+#define LATAVG			2
+#define LATMAX			3
+#define LATP99			4
+#define LATACK			8
+
+/* GETINTLATENCY a1 */
+#define PRNTLINE		6
+#define TERMLINE		7
+
+/* DELAY a1: a longer delay is cut down to this many seconds, a negative one
+ * terminates. sysSupport.c cuts it with MAXDELAY in h/const.h, which this
+ * must match. */
+#define MAXDELAY		2000
 
 #define SEG0			0x00000000
 #define SEG1			0x40000000
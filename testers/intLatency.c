@@ -0,0 +1,74 @@
+/*	Interrupt latency by device
+ *
+ *	Writes LINES lines to its printer and terminal so they interrupt,
+ *	then asks the nucleus with GETINTLATENCY, for every printer and
+ *	terminal that has interrupted since boot, how long it took from an
+ *	interrupt being taken to the device being acknowledged (ack) and to
+ *	the process it woke being dispatched (run). Each is printed as
+ *	min/avg/max/p99 in us; the p99 is the upper end of the power of two
+ *	range the 99th percentile falls in. Load it with benchFlood on the
+ *	other flash devices to see the latencies under load.
+ */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define LINES	10
+#define DEVS	8
+#define STATS	4
+
+int stats[STATS] = {LATMIN, LATAVG, LATMAX, LATP99};
+
+/* Print the latencies of device dev on line, read before printing
+ * anything since the printing adds samples of its own. */
+void printDevice(int line, int dev) {
+	int count, ack[STATS], run[STATS];
+	int k;
+
+	count = SYSCALL(GETINTLATENCY, line, dev, LATACK + LATCOUNT);
+	if (count <= 0)
+		return;
+	for (k = 0; k < STATS; k++) {
+		ack[k] = SYSCALL(GETINTLATENCY, line, dev, LATACK + stats[k]);
+		run[k] = SYSCALL(GETINTLATENCY, line, dev, stats[k]);
+	}
+
+	print(WRITETERMINAL, (line == PRNTLINE) ? "printer " : "terminal ");
+	printNum(dev);
+	print(WRITETERMINAL, ": ");
+	printNum(count);
+	print(WRITETERMINAL, " ints, ack");
+	for (k = 0; k < STATS; k++) {
+		print(WRITETERMINAL, (k == 0) ? " " : "/");
+		printNum(ack[k]);
+	}
+	print(WRITETERMINAL, " run");
+	for (k = 0; k < STATS; k++) {
+		print(WRITETERMINAL, (k == 0) ? " " : "/");
+		printNum(run[k]);
+	}
+	print(WRITETERMINAL, " us\n");
+}
+
+void main() {
+	int i;
+
+	if (SYSCALL(GETINTLATENCY, PRNTLINE, DEVS, LATCOUNT) != -1) {
+		print(WRITETERMINAL, "ERROR: GETINTLATENCY took a bad device\n");
+		SYSCALL(TERMINATE, 0, 0, 0);
+	}
+
+	for (i = 0; i < LINES; i++) {
+		print(WRITEPRINTER, "intLatency: keeping the printer busy\n");
+		print(WRITETERMINAL, "intLatency: keeping the terminal busy\n");
+	}
+
+	print(WRITETERMINAL, "interrupt latency, min/avg/max/p99 us\n");
+	for (i = 0; i < DEVS; i++)
+		printDevice(PRNTLINE, i);
+	for (i = 0; i < DEVS; i++)
+		printDevice(TERMLINE, i);
+
+	SYSCALL(TERMINATE, 0, 0, 0);
+}
@@ -18,3 +18,51 @@ void print(int device, char *str) {
 		SYSCALL (TERMINATE, 0, 0, 0);
 	}
 }
+
+
+/* Print n in decimal on the terminal */
+void printNum(unsigned int n) {
+	char buf[11];
+	int i = 10;
+
+	buf[i] = EOS;
+	do {
+		buf[--i] = '0' + (n % 10);
+		n /= 10;
+	} while (n > 0);
+	print(WRITETERMINAL, &buf[i]);
+}
+
+
+/* Report a benchmark on the terminal as one machine readable line,
+ *	BENCH name n us
+ * n operations (or bytes) took us microseconds. bench/benchCompare.sh
+ * picks these lines out of terminal logs. */
+void printBench(char *name, unsigned int n, unsigned int us) {
+	char line[64];
+	char *d = line;
+	char *s;
+	unsigned int nums[2];
+	char buf[11];
+	int i, k;
+
+	nums[0] = n;
+	nums[1] = us;
+	for (s = "BENCH "; *s != '\0'; s++)
+		*d++ = *s;
+	for (s = name; *s != '\0' && d < line + 30; s++)
+		*d++ = *s;
+	for (k = 0; k < 2; k++) {
+		*d++ = ' ';
+		i = 10;
+		do {
+			buf[--i] = '0' + (nums[k] % 10);
+			nums[k] /= 10;
+		} while (nums[k] > 0);
+		while (i < 10)
+			*d++ = buf[i++];
+	}
+	*d++ = '\n';
+	*d = '\0';
+	print(WRITETERMINAL, line);
+}
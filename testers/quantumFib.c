@@ -0,0 +1,61 @@
+/*	Time slice length against throughput
+ *
+ *	Runs the fibEleven job, Fib(11), FIBREPS times at each quantum in
+ *	quanta[], setting it with SETQUANTUM first. For each it prints how
+ *	long the batch took and how often the U-proc was given the CPU per
+ *	second meanwhile (GETCPUSTATS). Load it next to fibEleven or other
+ *	CPU bound testers so the slices are actually contended for: longer
+ *	slices should mean fewer switches and a shorter batch.
+ */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define FIBREPS		200
+#define QUANTA		4
+
+int quanta[QUANTA] = {1000, 5000, 20000, 80000};	/* us */
+
+int fib (int i) {
+	if ((i == 1) || (i ==2))
+		return (1);
+
+	return(fib(i-1)+fib(i-2));
+}
+
+void main() {
+	unsigned int start, elapsed, dispatches;
+	int q, i;
+
+	print(WRITETERMINAL, "quantumFib starts\n");
+
+	for (q = 0; q < QUANTA; q++) {
+		if (SYSCALL(SETQUANTUM, quanta[q], 0, 0) < 0) {
+			print(WRITETERMINAL, "ERROR: quantum refused\n");
+			SYSCALL(TERMINATE, 0, 0, 0);
+		}
+
+		start = SYSCALL(GET_TOD, 0, 0, 0);
+		dispatches = SYSCALL(GETCPUSTATS, CPUDISPATCHES, 0, 0);
+		for (i = 0; i < FIBREPS; i++) {
+			if (fib(11) != 89) {
+				print(WRITETERMINAL, "ERROR: Recursion problems\n");
+				SYSCALL(TERMINATE, 0, 0, 0);
+			}
+		}
+		dispatches = SYSCALL(GETCPUSTATS, CPUDISPATCHES, 0, 0) - dispatches;
+		elapsed = SYSCALL(GET_TOD, 0, 0, 0) - start;
+
+		print(WRITETERMINAL, "quantum ");
+		printNum(quanta[q]);
+		print(WRITETERMINAL, " us: ");
+		printNum(elapsed);
+		print(WRITETERMINAL, " us, ");
+		/* dispatches * SECOND / elapsed without overflowing */
+		printNum((dispatches * 1000) / ((elapsed / 1000) + 1));
+		print(WRITETERMINAL, " switches/s\n");
+	}
+
+	SYSCALL(TERMINATE, 0, 0, 0);
+}
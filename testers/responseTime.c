@@ -0,0 +1,41 @@
+/*	Interactive response time under a CPU bound load
+ *
+ *	Writes RESPLINES short lines to the terminal, one at a time, and times
+ *	each SYS12 with GET_TOD. Each character makes the U-proc wait for a
+ *	terminal interrupt and then for the CPU again, so the times mostly show
+ *	how long an I/O bound process sits behind CPU bound ones. Load it on
+ *	half of the flash devices and fibEleven on the other half, and compare
+ *	the averages with the nucleus built with SCHED=RR and SCHED=MLFQ.
+ */
+
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+#define RESPLINES	20
+
+void main() {
+	unsigned int start, took, total, worst;
+	int i;
+
+	print(WRITETERMINAL, "responseTime starts\n");
+
+	total = worst = 0;
+	for (i = 0; i < RESPLINES; i++) {
+		start = SYSCALL(GET_TOD, 0, 0, 0);
+		print(WRITETERMINAL, "ping\n");
+		took = SYSCALL(GET_TOD, 0, 0, 0) - start;
+
+		total += took;
+		if (took > worst)
+			worst = took;
+	}
+
+	print(WRITETERMINAL, "responseTime avg ");
+	printNum(total / RESPLINES);
+	print(WRITETERMINAL, " us max ");
+	printNum(worst);
+	print(WRITETERMINAL, " us per line\n");
+
+	SYSCALL(TERMINATE, 0, 0, 0);
+}